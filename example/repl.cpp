@@ -1060,8 +1060,9 @@ std::string binary_op_left_command_evaluator(COMMAND_PARAMS)
 
     if (global_config->binary_op_exists(symbol_tok.value))
     {
-        global_config->get_binary_op(symbol_tok.value).operate = op;
-        global_config->get_binary_op(symbol_tok.value).assoc   = fluxins::associativity::left;
+        auto &binary_op   = global_config->get_binary_op(symbol_tok.value);
+        binary_op.operate = op;
+        binary_op.assoc   = fluxins::associativity::left;
     }
     else
     {
@@ -1127,8 +1128,9 @@ std::string binary_op_right_command_evaluator(COMMAND_PARAMS)
 
     if (global_config->binary_op_exists(symbol_tok.value))
     {
-        global_config->get_binary_op(symbol_tok.value).operate = op;
-        global_config->get_binary_op(symbol_tok.value).assoc   = fluxins::associativity::right;
+        auto &binary_op   = global_config->get_binary_op(symbol_tok.value);
+        binary_op.operate = op;
+        binary_op.assoc   = fluxins::associativity::right;
     }
     else
     {
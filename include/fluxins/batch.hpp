@@ -0,0 +1,62 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides batched (columnar) evaluation of bytecode, which
+/// evaluates one expression for many rows of variable values at once.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+
+namespace fluxins {
+
+/// Values of a variable for each row of a batch.
+struct column {
+    std::string            name;   ///< Name of the variable.
+    std::span<const float> values; ///< Value of the variable for each row.
+};
+
+/// Number of rows evaluated together, operator-at-a-time. Intermediate values
+/// of a block are small enough to stay in the cache.
+inline constexpr std::size_t batch_block_size = 256;
+
+/// Execute the bytecode for each row of the columns.
+///
+/// Variables that are not provided by the columns are resolved from the
+/// context once per batch. Functions are also resolved once per batch. Each
+/// instruction is applied to a block of rows at once, built-in operators (see
+/// `intrinsic`) are applied without calling `operate`. Operators obtained
+/// through the `get_*_op()` functions of the config are no longer built-in,
+/// their `operate` is always called.
+///
+/// When the condition of a conditional operator differs within a block, the
+/// rows of that block continue executing one by one from the branch they take.
+///
+/// @param output Receives the value of each row, its size is the number of
+///               rows.
+///
+/// @exception std::invalid_argument Thrown when a column has less values than
+///            the number of rows.
+/// @exception code_error Thrown when a referenced symbol is missing, any row
+///            fails to evaluate, or the config was modified after compiling.
+void execute_batch(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx,
+    std::span<const column>  columns,
+    std::span<float>         output);
+
+} // namespace fluxins
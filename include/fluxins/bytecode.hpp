@@ -0,0 +1,156 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides a linear bytecode representation of the AST and
+/// a stack-based interpreter to evaluate it without walking the tree.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+
+namespace fluxins {
+
+struct ast_node; // FWD
+
+/// Operation code of a bytecode instruction.
+enum class opcode {
+    push_number,   ///< Push the number stored (bitwise) in the operand.
+    load_variable, ///< Push the value of variable `names[operand]`.
+    call_function, ///< Pop `count` arguments, call function `names[operand]` and push the result.
+    unary_prefix,  ///< Apply unary prefix operator `unary_prefix_operators[operand]` to the top value.
+    unary_suffix,  ///< Apply unary suffix operator `unary_suffix_operators[operand]` to the top value.
+    binary,        ///< Pop two values, apply binary operator `binary_operators[operand]` and push the result.
+    jump,          ///< Continue execution at instruction `operand`.
+    jump_if_zero,  ///< Pop a value and continue execution at instruction `operand` if it is zero.
+    store_local,   ///< Copy the top value into local `operand` (without popping it).
+    load_local,    ///< Push the value of local `operand`.
+    max
+};
+
+/// Converts opcode to string for debugging.
+std::string opcode_to_string(opcode op);
+
+/// A single bytecode instruction.
+struct instruction {
+    opcode        op      = opcode::max; ///< Operation to perform.
+    std::uint32_t operand = 0;           ///< Operand, meaning depends on the opcode.
+    std::uint32_t count   = 0;           ///< Number of arguments (for `call_function`).
+};
+
+/// Linear program compiled from AST.
+///
+/// The operator operands are indices into the lists of operators of the config
+/// that the program was compiled with.
+///
+/// Locals hold values of subexpressions shared by multiple parents (see
+/// `shared_ast`), they are stored right after the stack, local `i` is at
+/// `stack[max_stack + i]`.
+///
+/// Bound programs (see `bind()`) read the variables and call the functions
+/// through the bound handles instead of looking them up by name in the context
+/// they are executed with, unbound symbols are still looked up by name.
+///
+/// @note The program is only valid for the version of the config it was
+///       compiled with, executing it with a modified config reports an error.
+///       Remember to recompile it when modifying the config.
+struct bytecode {
+    std::vector<instruction>   instructions; ///< List of all instructions.
+    std::vector<code_location> locations;    ///< Location of each instruction in the code (for error reporting).
+    std::vector<std::string>   names;        ///< Names of variables and functions referenced by instructions.
+
+    /// Bound variable for each name (if bound), see `bind()`.
+    std::vector<fluxins_variable *> variables;
+
+    /// Bound function for each name (if bound), see `bind()`.
+    std::vector<const fluxins_function *> functions;
+
+    std::size_t version   = 0; ///< Version of the config the program was compiled with (see `config::version`).
+    std::size_t max_stack = 0; ///< Maximum stack depth required to execute the program.
+    std::size_t locals    = 0; ///< Number of locals required to execute the program.
+    std::size_t depth     = 0; ///< Stack depth at the end of the program (used while compiling).
+
+    /// Locals holding a value at the end of the program (used while compiling).
+    std::vector<bool> computed_locals;
+
+    /// Append an instruction and update the stack depth.
+    /// @return Index of the appended instruction.
+    std::size_t emit(const instruction &inst, code_location location);
+
+    /// Get the index of the name in the list of names, adding it if absent.
+    std::uint32_t add_name(std::string_view name);
+};
+
+/// Get the string representation of the bytecode for debugging.
+std::string bytecode_to_string(const code &expr, const bytecode &program);
+
+/// Compile the AST into bytecode.
+/// @exception code_error Thrown when an operator cannot be found in the config.
+bytecode compile(
+    const code                &expr,
+    std::shared_ptr<ast_node>  ast,
+    std::shared_ptr<config>    cfg);
+
+/// Bind the variables and functions referenced by the bytecode to the symbols
+/// in the context, see `context::bind_variable()` and
+/// `context::bind_function()`.
+/// @note Remember to bind again when recompiling the program, and when
+///       removing or shadowing symbols in the context.
+void bind(bytecode &program, std::shared_ptr<context> ctx);
+
+/// Report the error for executing the bytecode with a different version of
+/// the config than it was compiled with.
+/// @return NaN, for the execution to return when the error is collected.
+float report_stale_program(const code &expr);
+
+/// Execute the bytecode for value.
+/// @exception code_error Thrown when a referenced symbol is missing, or the
+///            config was modified after compiling.
+float execute(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx);
+
+/// Execute the bytecode for value, with the variables and the stack provided
+/// by the caller.
+///
+/// The variable of each name is read from `variables[i]` for `names[i]` when
+/// present (`variables` may be `nullptr`), and looked up by name in the
+/// context otherwise (`ctx` may be `nullptr`). The stack must hold at least
+/// `max_stack + locals` values, and `args` is reused for function arguments.
+///
+/// @exception code_error Thrown when a referenced symbol is missing, or the
+///            config was modified after compiling.
+float execute(
+    const bytecode                &program,
+    const code                    &expr,
+    const config                  &cfg,
+    const context                 *ctx,
+    const fluxins_variable *const *variables,
+    float                         *stack,
+    std::vector<float>            &args);
+
+/// Execute the bytecode for value, without throwing.
+/// @return Value, or the first error reported during execution.
+std::expected<float, error_info> try_execute(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx);
+
+} // namespace fluxins
@@ -0,0 +1,135 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides a cache of parsed expressions, shared between
+/// expressions parsed from the same text with the same config.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/parser.hpp"
+
+namespace fluxins {
+
+/// Expression parsed from text, shared by the cache.
+///
+/// @note The parsed expression is immutable. The AST is never optimized or
+///       bound, remember to `clone()` it before doing so.
+struct parsed_expression {
+    std::vector<packed_token>       tokens; ///< Tokens of the expression.
+    std::shared_ptr<const ast_node> ast;    ///< AST of the expression.
+};
+
+/// Counters of the cache.
+struct cache_statistics {
+    std::size_t hits      = 0; ///< Number of expressions found in the cache.
+    std::size_t misses    = 0; ///< Number of expressions parsed because they were not in the cache.
+    std::size_t evictions = 0; ///< Number of least recently used expressions removed to stay within the capacity.
+    std::size_t size      = 0; ///< Number of expressions in the cache.
+    std::size_t capacity  = 0; ///< Maximum number of expressions in the cache.
+};
+
+/// Thread-safe, size-bounded cache of parsed expressions.
+///
+/// Expressions are cached by their text and config. Parsing depends on the
+/// operators and the precedence table of the config, so expressions are only
+/// found for the same config with the same version (see `config::version`).
+/// The config is referenced weakly, cached expressions of destroyed configs
+/// are never found.
+///
+/// When the cache is full, the least recently used expression is removed.
+/// Expressions with errors are not cached.
+struct expression_cache {
+    /// Creates the cache with the maximum number of expressions.
+    /// @note Capacity of zero disables the cache.
+    expression_cache(std::size_t capacity = 256);
+
+    /// Find the parsed expression in the cache, or parse and cache it.
+    /// @return Parsed expression, or `nullptr` when an error was collected
+    ///         (see `error_sink`).
+    /// @exception code_error Thrown when syntactical error occurs during parsing.
+    std::shared_ptr<const parsed_expression> parse(const code &expr, std::shared_ptr<config> cfg);
+
+    /// Find the parsed expression in the cache.
+    /// @return Parsed expression, or `nullptr` when it is not in the cache.
+    std::shared_ptr<const parsed_expression> find(std::string_view expr, const std::shared_ptr<config> &cfg);
+
+    /// Cache the parsed expression, replacing the expression of the same text
+    /// and config.
+    void insert(std::string_view expr, const std::shared_ptr<config> &cfg, std::shared_ptr<const parsed_expression> parsed);
+
+    /// Remove all the expressions from the cache.
+    void clear();
+
+    /// Change the maximum number of expressions, removing the least recently
+    /// used expressions when there are more.
+    void set_capacity(std::size_t capacity);
+
+    /// Get the counters of the cache.
+    cache_statistics statistics() const;
+
+    /// Reset the hit, miss and eviction counters.
+    void reset_statistics();
+
+    /// Key of a cached expression.
+    struct key {
+        std::string_view expr;    ///< Text of the expression (owned by the entry).
+        const config    *cfg;     ///< Config the expression was parsed with.
+        std::size_t      version; ///< Version of the config.
+
+        bool operator==(const key &other) const = default;
+    };
+
+    /// Hash of the key.
+    struct key_hash {
+        std::size_t operator()(const key &k) const;
+    };
+
+    /// Cached expression.
+    struct entry {
+        std::string                              expr;    ///< Text of the expression.
+        const config                            *cfg;     ///< Config the expression was parsed with.
+        std::size_t                              version; ///< Version of the config.
+        std::weak_ptr<config>                    owner;   ///< Config the expression was parsed with, to check if it was destroyed.
+        std::shared_ptr<const parsed_expression> parsed;  ///< Parsed expression.
+    };
+
+    /// Remove the least recently used expressions until within the capacity.
+    /// @note Remember to lock the mutex.
+    void evict();
+
+    /// Guards all the members below.
+    /// @note Remember to lock the mutex when accessing the members directly.
+    mutable std::mutex mutex;
+
+    std::size_t capacity;      ///< Maximum number of expressions.
+    std::size_t hits      = 0; ///< Number of hits.
+    std::size_t misses    = 0; ///< Number of misses.
+    std::size_t evictions = 0; ///< Number of evictions.
+
+    /// Cached expressions, from the most recently used.
+    std::list<entry> entries;
+
+    /// Position of each cached expression in `entries`, the text of the keys
+    /// is owned by the entries.
+    std::unordered_map<key, std::list<entry>::iterator, key_hash> positions;
+};
+
+/// Get the cache used by `express()` and `expression::parse()`.
+expression_cache &global_cache();
+
+} // namespace fluxins
@@ -22,47 +22,36 @@ namespace fluxins {
 /// Stores code and provides utilities.
 struct code {
     std::string expr; ///< The code itself.
-    std::string name; ///< Name of the code (initially randomly generated).
+
+    /// Name of the code.
+    ///
+    /// When not provided, the name is randomly generated when it is first
+    /// needed (when reporting an error). Use `get_name()` to get the name
+    /// generated on demand.
+    mutable std::string name;
 
     // Utilities
 
     code() : expr(""), name("")
-    {
-        randomize_name();
-    }
+    {}
 
     code(std::string_view expr) : expr(expr), name("")
-    {
-        randomize_name();
-        split_lines();
-    }
+    {}
 
     code(std::string_view expr, std::string name) : expr(expr), name(name)
-    {
-        split_lines();
-    }
+    {}
 
     code(const std::string &expr) : expr(expr), name("")
-    {
-        randomize_name();
-        split_lines();
-    }
+    {}
 
     code(const std::string &expr, std::string name) : expr(expr), name(name)
-    {
-        split_lines();
-    }
+    {}
 
     code(const char *expr) : expr(expr), name("")
-    {
-        randomize_name();
-        split_lines();
-    }
+    {}
 
     code(const char *expr, std::string name) : expr(expr), name(name)
-    {
-        split_lines();
-    }
+    {}
 
     template <typename type>
         requires requires(const type &value) { std::to_string(value); }
@@ -70,21 +59,60 @@ struct code {
     {}
 
     /// Randomize the name of the code.
-    void randomize_name();
+    ///
+    /// @note Randomizing is not synchronized, call this (or `get_name()`)
+    ///       before sharing the unnamed code between threads that may report
+    ///       errors.
+    void randomize_name() const;
+
+    /// Get the name of the code, randomizing the name when it is empty.
+    const std::string &get_name() const
+    {
+        if (name.empty())
+        {
+            randomize_name();
+        }
+        return name;
+    }
 
     /// Lines of the code.
     ///
     /// For each pair in this vector, the first element is the beginning index
     /// of the line, and the second element is the length of the line.
     ///
+    /// The lines are split lazily, when a location in the code is first
+    /// queried. Use `line_index()` to get the lines split on demand.
+    ///
     /// @note Assuming the line breaks are `\n` characters. `\r\n` is not supported.
-    std::vector<std::pair<std::size_t, std::size_t>> lines;
+    mutable std::vector<std::pair<std::size_t, std::size_t>> lines;
+
+    /// True when `lines` is split from the current code.
+    ///
+    /// Remember to call `split_lines()` when modifying the code after a
+    /// location in the code was queried.
+    mutable bool lines_split = false;
 
     /// Split the code into lines.
-    void split_lines();
+    ///
+    /// @note Splitting is not synchronized, call this before sharing the code
+    ///       between threads that may query the locations in the code.
+    void split_lines() const;
+
+    /// Get the lines of the code, splitting the code into lines when it is not
+    /// already split.
+    const std::vector<std::pair<std::size_t, std::size_t>> &line_index() const
+    {
+        if (!lines_split)
+        {
+            split_lines();
+        }
+        return lines;
+    }
 
     /// Get line number and column number from the position.
     ///
+    /// The line is found by binary search over the beginning of the lines.
+    ///
     /// @note Line number starts from 1, column number starts from 0.
     ///       Do not just plug the first element from the pair into `lines[]`.
     ///
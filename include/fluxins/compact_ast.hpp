@@ -0,0 +1,114 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides a compact representation of the AST, which keeps
+/// all the nodes of an expression in one contiguous arena.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+
+namespace fluxins {
+
+struct ast_node;         // FWD
+struct evaluation_frame; // FWD
+
+/// Kind of a compact AST node.
+enum class compact_kind : std::uint8_t {
+    number,       ///< Number stored (bitwise) in the value.
+    variable,     ///< Variable `names[value]`.
+    function,     ///< Call to function `names[value]` with `count` arguments.
+    unary_prefix, ///< Unary prefix operator `unary_prefix_operators[value]` with one operand.
+    unary_suffix, ///< Unary suffix operator `unary_suffix_operators[value]` with one operand.
+    binary,       ///< Binary operator `binary_operators[value]` with left and right operands.
+    conditional,  ///< Conditional with condition, true value and false value.
+    max
+};
+
+/// Converts compact AST node kind to string for debugging.
+std::string compact_kind_to_string(compact_kind kind);
+
+/// A single node of compact AST.
+///
+/// Children of the node are `children[first]` to `children[first + count - 1]`
+/// (indices of the nodes in the arena).
+struct compact_node {
+    compact_kind  kind  = compact_kind::max; ///< Kind of the node.
+    std::uint16_t count = 0;                 ///< Number of children.
+    std::uint32_t value = 0;                 ///< Value, meaning depends on the kind.
+    std::uint32_t first = 0;                 ///< Index of the first child in `children`.
+};
+
+/// AST stored in one contiguous arena, with index-based children.
+///
+/// Nodes are stored after their children, so the root is the last node.
+/// Subexpressions shared by multiple parents (see `shared_ast`) are stored
+/// once and referenced by all the parents.
+///
+/// The locations of nodes are stored in a side table, which is only read for
+/// reporting errors (and passing to the operators and functions).
+///
+/// The operator values are indices into the lists of operators of the config
+/// that the AST was compacted with.
+///
+/// @note The compact AST is only valid for the config it was compacted with.
+///       Remember to compact again when modifying the config.
+struct compact_ast {
+    std::vector<compact_node>  nodes;     ///< Arena of all nodes.
+    std::vector<std::uint32_t> children;  ///< Children of all nodes.
+    std::vector<std::string>   names;     ///< Names of variables and functions referenced by nodes.
+    std::vector<code_location> locations; ///< Location of each node in the code (for error reporting).
+
+    /// Index of the node compacted from each shared node (used while
+    /// compacting).
+    std::vector<std::uint32_t> shared_nodes;
+
+    /// Append a node with its children and location.
+    /// @return Index of the appended node.
+    std::uint32_t add_node(
+        compact_kind                   kind,
+        std::uint32_t                  value,
+        std::span<const std::uint32_t> node_children,
+        code_location                  location);
+
+    /// Get the index of the name in the list of names, adding it if absent.
+    std::uint32_t add_name(std::string_view name);
+
+    /// Get the index of the root node.
+    std::uint32_t root() const
+    {
+        return (std::uint32_t) nodes.size() - 1;
+    }
+};
+
+/// Get the string representation of the compact AST for debugging.
+std::string compact_ast_to_string(const code &expr, const compact_ast &tree);
+
+/// Compact the AST into one contiguous arena.
+/// @exception code_error Thrown when an operator cannot be found in the config.
+compact_ast compact(
+    const code               &expr,
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<config>   cfg);
+
+/// Evaluate the compact AST for value.
+/// @note The config of the frame must be the config the AST was compacted
+///       with.
+/// @exception code_error Thrown when invalid expression was provided.
+float evaluate(const compact_ast &tree, const evaluation_frame &frame);
+
+} // namespace fluxins
@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <string_view>
@@ -38,12 +40,45 @@ enum class associativity {
 /// Converts associativity to string for debugging.
 std::string associativity_to_string(associativity assoc);
 
+/// Known semantics of an operator's `operate` function.
+///
+/// Backends (such as the native compiler) use this to lower built-in operators
+/// into native instructions instead of calling `operate`. Unary operators use
+/// the binary semantics with an implicit left operand of `0` (for `add`,
+/// `subtract` and `equal`) or `1` (for `multiply` and `divide`).
+///
+/// @note The `get_*_op()` functions of the config reset it to `intrinsic::none`,
+///       as `operate` may be replaced through the returned reference. Reset it
+///       when replacing `operate` of a built-in operator in the lists of
+///       operators directly.
+enum class intrinsic {
+    none,          ///< Unknown semantics, `operate` is always called.
+    add,           ///< `x + y`.
+    subtract,      ///< `x - y`.
+    multiply,      ///< `x * y`.
+    divide,        ///< `x / y`, throws on division by zero.
+    power,         ///< `std::pow(x, y)`.
+    equal,         ///< `x == y`.
+    not_equal,     ///< `x != y`.
+    less,          ///< `x < y`.
+    greater,       ///< `x > y`.
+    less_equal,    ///< `x <= y`.
+    greater_equal, ///< `x >= y`.
+    logical_and,   ///< `x != 0 && y != 0`.
+    logical_or,    ///< `x != 0 || y != 0`.
+    minimum,       ///< `std::fmin(x, y)`.
+    maximum,       ///< `std::fmax(x, y)`.
+    max
+};
+
 /// Unary operator type.
 struct unary_operator {
     std::string symbol; ///< Unary operator symbol.
 
     /// Function to call when operator "operates" or performs its thing on a value.
     std::function<float(const code &expr, code_location location, float x)> operate;
+
+    intrinsic builtin = intrinsic::none; ///< Known semantics of `operate` (if any).
 };
 
 /// Binary operator type.
@@ -54,6 +89,71 @@ struct binary_operator {
 
     /// Function to call when operator "operates" or performs its thing on two values.
     std::function<float(const code &expr, code_location location, float x, float y)> operate;
+
+    intrinsic builtin = intrinsic::none; ///< Known semantics of `operate` (if any).
+};
+
+/// Kind of an operator, by its position relative to the operands.
+enum class operator_kind {
+    unary_prefix, ///< Unary operator before the operand.
+    unary_suffix, ///< Unary operator after the operand.
+    binary,       ///< Binary operator between the operands.
+    max
+};
+
+/// Lookup structure for finding operators by symbol, compiled from the lists
+/// of operators of a config.
+///
+/// The symbols are stored in a trie with one state for every prefix of the
+/// symbols. Characters are mapped to a dense alphabet of the characters used
+/// in the symbols, and the transitions of each state are stored in one flat
+/// table, so finding an operator takes one table lookup per character of the
+/// symbol.
+///
+/// @note The lookup is immutable, it is rebuilt from scratch whenever
+///       operators are added or removed.
+struct operator_trie {
+    /// Position of each character in the alphabet, zero for characters not
+    /// used by any symbol.
+    std::array<std::uint8_t, 256> alphabet = {};
+
+    /// Size of the alphabet, including the unused characters.
+    std::size_t alphabet_size = 1;
+
+    /// Transitions of all states, `transitions[state * alphabet_size + c]` is
+    /// the next state after character `c`. The root state is zero, which is
+    /// also used when there is no transition.
+    std::vector<std::uint32_t> transitions;
+
+    /// Index of the operator of each kind whose symbol ends at each state,
+    /// `operators[state][kind]`.
+    std::vector<std::array<std::size_t, (std::size_t) operator_kind::max>> operators;
+
+    /// Version of the config the lookup was built for.
+    std::size_t version = (std::size_t) -1;
+
+    /// Build the lookup from the lists of operators.
+    static operator_trie build(
+        const std::vector<unary_operator>  &unary_prefix_operators,
+        const std::vector<unary_operator>  &unary_suffix_operators,
+        const std::vector<binary_operator> &binary_operators);
+
+    /// Find the index of the operator in its list of operators.
+    /// @return Index of the operator, or `(std::size_t) -1` if not found.
+    std::size_t find(std::string_view symbol, operator_kind kind) const;
+};
+
+/// Binding power of a binary operator, precomputed from the precedence table
+/// for the precedence climbing parser.
+///
+/// The minimum binding power of the operators in the right operand is equal to
+/// `power` for right associative operators, and one more for left associative
+/// operators. It is not precomputed, the parser reads the associativity of
+/// the operator when parsing as it may be modified in-place.
+struct binary_op_binding {
+    /// Binding power of the operator, higher binds tighter. Zero when the
+    /// operator has no precedence level assigned.
+    std::size_t power = 0;
 };
 
 /// Parser and evaluator configuration.
@@ -68,6 +168,29 @@ struct config {
     std::vector<unary_operator> unary_prefix_operators; ///< List of all unary prefix operators.
     std::vector<unary_operator> unary_suffix_operators; ///< List of all unary suffix operators.
 
+    /// Version of the lists of operators, incremented whenever an operator is
+    /// added, removed or obtained for modifying (see `get_binary_op()`), or the
+    /// precedence table is modified. Parsed operators
+    /// remember their index in the lists along with the version, and find the
+    /// operator by symbol again when the version has changed. Cached parsed
+    /// expressions (see `expression_cache`) are only used for the same version.
+    ///
+    /// Remember to increment the version when modifying the lists of operators,
+    /// the precedence table or the associativity of operators directly.
+    std::size_t version = 0;
+
+    /// Lookup for finding operators by symbol, rebuilt whenever an operator is
+    /// added or removed. The `find_*_op` functions use the lookup when it was
+    /// built for the current version, and search the lists of operators
+    /// otherwise.
+    ///
+    /// Remember to call `update_lookup()` after incrementing the version when
+    /// modifying the lists of operators directly.
+    operator_trie lookup;
+
+    /// Rebuild the lookup from the lists of operators.
+    void update_lookup();
+
     /// Appends a new unary prefix operator to the list of operators.
     /// @exception std::invalid_argument Thrown when invalid symbol is specified.
     /// @exception std::logic_error Thrown when operator already exists in the
@@ -86,6 +209,10 @@ struct config {
     bool unary_prefix_op_exists(std::string_view symbol) const;
 
     /// Get unary prefix operator from symbol.
+    ///
+    /// The operator may be modified through the returned reference, so its
+    /// semantics are reset (see `intrinsic`) and the version is incremented.
+    ///
     /// @exception std::invalid_argument Thrown when invalid symbol is specified.
     unary_operator &get_unary_prefix_op(std::string_view symbol);
 
@@ -107,6 +234,10 @@ struct config {
     bool unary_suffix_op_exists(std::string_view symbol) const;
 
     /// Get unary suffix operator from symbol.
+    ///
+    /// The operator may be modified through the returned reference, so its
+    /// semantics are reset (see `intrinsic`) and the version is incremented.
+    ///
     /// @exception std::invalid_argument Thrown when invalid symbol is specified.
     unary_operator &get_unary_suffix_op(std::string_view symbol);
 
@@ -125,6 +256,18 @@ struct config {
     ///       effectively inexistent for the parser.
     std::vector<std::vector<std::size_t>> binary_op_precedence;
 
+    /// Binding power of each binary operator, in the same order as
+    /// `binary_operators`. Computed from the precedence table whenever binary
+    /// operators or their precedence are modified.
+    ///
+    /// Remember to call `update_bindings()` when modifying the list of binary
+    /// operators or the precedence table directly.
+    std::vector<binary_op_binding> binary_op_bindings;
+
+    /// Compute the binding power of each binary operator from the precedence
+    /// table.
+    void update_bindings();
+
     /// Appends a new binary operator to the list of operators.
     /// @exception std::invalid_argument Thrown when invalid symbol is specified.
     /// @exception std::logic_error Thrown when operator already exists in the
@@ -148,6 +291,11 @@ struct config {
     bool binary_op_exists(std::string_view symbol) const;
 
     /// Get binary operator from symbol.
+    ///
+    /// The operator may be modified through the returned reference, so its
+    /// semantics are reset (see `intrinsic`) and the version is incremented,
+    /// expressions parsed before are not copied from the cache anymore.
+    ///
     /// @exception std::invalid_argument Thrown when invalid symbol is specified.
     binary_operator &get_binary_op(std::string_view symbol);
 
@@ -10,11 +10,15 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "fluxins/code.hpp"
@@ -25,15 +29,15 @@
 #define FLUXINS_FN_PARAMS const fluxins::code &expr, fluxins::code_location location, const std::vector<float> &params
 
 /// For convenience, use `FLUXINS_FN_ARITY` instead of
-/// `if (params.size() != arity) { throw fluxins::invalid_arity("function_name", arity, params.size(), expr, location); }`.
-#define FLUXINS_FN_ARITY(name, arity)                                                     \
-    do                                                                                    \
-    {                                                                                     \
-        if (params.size() != (arity))                                                     \
-        {                                                                                 \
-            throw fluxins::invalid_arity((name), params.size(), (arity), expr, location); \
-        }                                                                                 \
-    }                                                                                     \
+/// `if (params.size() != arity) { return fluxins::report_error(fluxins::error_info::arity_mismatch("function_name", params.size(), arity, location), expr); }`.
+#define FLUXINS_FN_ARITY(name, arity)                                                                                 \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if (params.size() != (arity))                                                                                 \
+        {                                                                                                             \
+            return fluxins::report_error(fluxins::error_info::arity_mismatch((name), params.size(), (arity), location), expr); \
+        }                                                                                                             \
+    }                                                                                                                 \
     while (0)
 
 namespace fluxins {
@@ -51,22 +55,222 @@ using fluxins_function = std::function<float(
     code_location             location,
     const std::vector<float> &params)>;
 
-using fluxins_variables = std::unordered_map<std::string, fluxins_variable>;
-using fluxins_functions = std::unordered_map<std::string, fluxins_function>;
+/// Vectorized function signature, evaluating a function for many rows at once.
+///
+/// `params` holds one array of `output.size()` values for each parameter. The
+/// output may be the same memory as the first parameter.
+using fluxins_vector_function = std::function<void(
+    std::span<const float *const> params,
+    std::span<float>              output)>;
+
+/// Vectorized implementation of a function.
+struct vector_function {
+    /// Number of parameters, calls with other number of arguments use the
+    /// scalar function.
+    std::size_t arity = 0;
+
+    /// Kernel evaluating the function.
+    fluxins_vector_function kernel;
+};
+
+/// Properties of a function that the optimizations may rely on.
+struct function_traits {
+    /// Whether the function is pure, i.e., it always returns the same value
+    /// for the same arguments and has no side effects. Calls to pure functions
+    /// may be folded or shared, evaluating them less times than they appear.
+    bool pure = false;
+
+    /// Minimum number of parameters that the function accepts.
+    std::size_t min_arity = 0;
+
+    /// Maximum number of parameters that the function accepts.
+    std::size_t max_arity = (std::size_t) -1;
+
+    /// Check if the function accepts the number of arguments.
+    bool accepts(std::size_t arity) const
+    {
+        return arity >= min_arity && arity <= max_arity;
+    }
+};
+
+using fluxins_variables        = std::unordered_map<std::string, fluxins_variable>;
+using fluxins_functions        = std::unordered_map<std::string, fluxins_function>;
+using fluxins_vector_functions = std::unordered_map<std::string, vector_function>;
+using fluxins_function_traits  = std::unordered_map<std::string, function_traits>;
+
+/// Get the number of structural changes made to all contexts so far (see
+/// `context::revision()`), which only changes when any context changes
+/// structurally.
+std::size_t context_epoch();
+
+/// Record a structural change made to a context.
+/// @return The new epoch, which is greater than any epoch returned before.
+std::size_t advance_context_epoch();
+
+/// Symbols of a context by name, which records when a symbol was last added
+/// or removed (including directly through the map) for `context::revision()`.
+/// Assigning an existing symbol is not recorded.
+///
+/// Members of the map that may add or remove symbols but are not provided
+/// here (such as `merge()`) are not available.
+template <typename symbol_type>
+struct symbol_map : std::unordered_map<std::string, symbol_type> {
+    using base_type = std::unordered_map<std::string, symbol_type>;
+
+    /// Epoch of the last symbol added or removed (see
+    /// `advance_context_epoch()`).
+    std::size_t version = 0;
+
+    using base_type::base_type;
+
+    symbol_map()                   = default;
+    symbol_map(const symbol_map &) = default;
+    symbol_map(symbol_map &&)      = default;
+
+    symbol_map &operator=(const symbol_map &other)
+    {
+        base_type::operator=(other);
+        modified();
+        return *this;
+    }
+
+    symbol_map &operator=(symbol_map &&other)
+    {
+        base_type::operator=(std::move(other));
+        modified();
+        return *this;
+    }
+
+    symbol_map &operator=(std::initializer_list<typename base_type::value_type> list)
+    {
+        base_type::operator=(list);
+        modified();
+        return *this;
+    }
+
+    /// Record that a symbol was added or removed.
+    void modified()
+    {
+        version = advance_context_epoch();
+    }
+
+    symbol_type &operator[](const std::string &name)
+    {
+        auto [it, inserted] = base_type::try_emplace(name);
+        if (inserted) modified();
+        return it->second;
+    }
+
+    template <typename... args_type>
+    auto emplace(args_type &&...args)
+    {
+        auto result = base_type::emplace(std::forward<args_type>(args)...);
+        if (result.second) modified();
+        return result;
+    }
+
+    template <typename... args_type>
+    auto try_emplace(const std::string &name, args_type &&...args)
+    {
+        auto result = base_type::try_emplace(name, std::forward<args_type>(args)...);
+        if (result.second) modified();
+        return result;
+    }
+
+    auto insert(const typename base_type::value_type &value)
+    {
+        auto result = base_type::insert(value);
+        if (result.second) modified();
+        return result;
+    }
+
+    template <typename value_type>
+    auto insert_or_assign(const std::string &name, value_type &&value)
+    {
+        auto result = base_type::insert_or_assign(name, std::forward<value_type>(value));
+        if (result.second) modified();
+        return result;
+    }
+
+    std::size_t erase(const std::string &name)
+    {
+        std::size_t erased = base_type::erase(name);
+        if (erased != 0) modified();
+        return erased;
+    }
+
+    auto erase(typename base_type::const_iterator it)
+    {
+        modified();
+        return base_type::erase(it);
+    }
+
+    auto erase(typename base_type::iterator it)
+    {
+        modified();
+        return base_type::erase(it);
+    }
+
+    void clear()
+    {
+        if (!base_type::empty()) modified();
+        base_type::clear();
+    }
+
+    void swap(symbol_map &other)
+    {
+        base_type::swap(other);
+        modified();
+        other.modified();
+    }
+
+    template <typename... args_type> void emplace_hint(args_type &&...)  = delete;
+    template <typename... args_type> void extract(args_type &&...)       = delete;
+    template <typename... args_type> void merge(args_type &&...)         = delete;
+};
 
 /// Context for expression's list of symbols.
 struct context {
     /// Variables accessible to all expressions using this context.
-    fluxins_variables variables;
+    symbol_map<fluxins_variable> variables;
 
     /// Functions accessible to all expressions using this context.
-    fluxins_functions functions;
+    /// @note Remember to call `modified()` when assigning an existing function
+    ///       directly, `set_function()` does it for you.
+    symbol_map<fluxins_function> functions;
+
+    /// Vectorized implementations of functions, used by batched evaluation.
+    /// @note The function with the same name must exist in this context.
+    ///       Remember to remove the vectorized function when modifying
+    ///       `functions` directly.
+    fluxins_vector_functions vector_functions;
+
+    /// Traits of functions, functions without traits are assumed impure.
+    /// @note The function with the same name must exist in this context.
+    ///       Remember to remove the traits when modifying `functions`
+    ///       directly, and to call `modified()` when assigning existing traits
+    ///       directly.
+    symbol_map<function_traits> traits;
 
     /// Allow inheriting symbols from another contexts.
     /// @note This context's symbols are prioritized over inherited ones when
-    ///       they conflict.
+    ///       they conflict. Remember to call `modified()` when modifying the
+    ///       parent contexts directly.
     std::vector<std::shared_ptr<context>> parents;
 
+    /// Epoch of the last structural change of the context other than adding or
+    /// removing symbols (which the maps of symbols record themselves), which
+    /// are assigning functions and inheriting contexts. Assigning an existing
+    /// variable is not a structural change, expressions compare the values of
+    /// the variables they read instead (see `expression::outdated()`).
+    std::size_t version = 0;
+
+    /// Record a structural change made to the context directly.
+    void modified()
+    {
+        version = advance_context_epoch();
+    }
+
     /// Populates the context with built-in variables and functions.
     ///
     /// Populate the context with a set of standard mathematical variables
@@ -84,31 +288,100 @@ struct context {
     ///       the context before adding custom symbols.
     void populate();
 
+    /// Get the epoch of the last structural change of this context and it's
+    /// parent contexts (recursively), which changes whenever any of them
+    /// changes structurally.
+    /// @note This visits all the parent contexts, compare `context_epoch()`
+    ///       first to skip it when no context has changed.
+    std::size_t revision() const;
+
+    /// Get the epoch of the last structural change of this context and it's
+    /// parent contexts (recursively) other than adding or removing variables,
+    /// which changes whenever a function or its traits are added, removed or
+    /// assigned through `set_function()`.
+    /// @note This visits all the parent contexts, like `revision()`.
+    std::size_t function_revision() const;
+
     /// Get variable from this context or it's parent contexts (recursively).
     std::optional<fluxins_variable> resolve_variable(const std::string &name) const;
 
+    /// Get a stable handle to the variable from this context or it's parent
+    /// contexts (recursively), which reads and updates the variable without
+    /// looking it up by name.
+    ///
+    /// The handle points into the context that resolves the variable, and
+    /// stays valid until the variable is removed from that context
+    /// (`set_variable()` updates the variable in-place).
+    ///
+    /// @note The handle keeps pointing to the same variable when a variable
+    ///       shadowing it is added later. Bind again when the revision changes
+    ///       (see `revision()`), as `expression::evaluate()` does.
+    /// @return `nullptr` when the variable is missing.
+    fluxins_variable *bind_variable(const std::string &name);
+
     /// Get function from this context or it's parent contexts (recursively).
     std::optional<fluxins_function> resolve_function(const std::string &name) const;
 
+    /// Get a stable, non-owning handle to the function from this context or
+    /// it's parent contexts (recursively), which calls the function without
+    /// looking it up by name or copying it.
+    ///
+    /// The handle points into the context that resolves the function, so it
+    /// calls the new function when the function is redefined with
+    /// `set_function()`, and stays valid until the function is removed from
+    /// that context.
+    ///
+    /// @note The handle keeps pointing to the same function when a function
+    ///       shadowing it is added later. Bind again when the revision changes
+    ///       (see `revision()`), as `expression::evaluate()` does.
+    /// @return `nullptr` when the function is missing.
+    const fluxins_function *bind_function(const std::string &name) const;
+
+    /// Get vectorized function from the context that `resolve_function()`
+    /// resolves the function from.
+    std::optional<vector_function> resolve_vector_function(const std::string &name) const;
+
+    /// Get traits of the function from the context that `resolve_function()`
+    /// resolves the function from.
+    /// @note Default traits (impure) are returned when the function or its
+    ///       traits are missing.
+    function_traits resolve_function_traits(const std::string &name) const;
+
     /// Assigns or inserts a variable to this context.
     /// @note This will override the variable if exists.
     context &set_variable(const std::string &name, const fluxins_variable &variable)
     {
-        variables[name] = variable;
+        variables.insert_or_assign(name, variable);
         return *this;
     }
 
-    /// Assigns or inserts a function to this context.
-    /// @note This will override the function if exists.
-    context &set_function(const std::string &name, const fluxins_function &function)
+    /// Assigns or inserts a function to this context, with its traits.
+    /// @note This will override the function and its traits if exists, and
+    ///       remove its vectorized function.
+    context &set_function(
+        const std::string      &name,
+        const fluxins_function &function,
+        const function_traits  &properties = {})
     {
         functions[name] = function;
+        traits[name]    = properties;
+        vector_functions.erase(name);
+        modified();
+        return *this;
+    }
+
+    /// Assigns or inserts a vectorized function for an existing function.
+    /// @note This will override the vectorized function if exists.
+    context &set_vector_function(const std::string &name, std::size_t arity, const fluxins_vector_function &kernel)
+    {
+        vector_functions[name] = { arity, kernel };
         return *this;
     }
 
     context &inherit_context(std::shared_ptr<context> parent)
     {
         parents.emplace_back(parent);
+        modified();
         return *this;
     }
 };
@@ -12,14 +12,33 @@
 
 #include <cstddef>
 #include <exception>
+#include <expected>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include "fluxins/code.hpp"
 
+/// Throw the exception, or terminate when built without exceptions
+/// (`FLUXINS_NO_EXCEPTIONS`).
+///
+/// Used for errors that are not errors in the code (such as modifying the
+/// config with invalid arguments), which are never collected as `error_info`.
+#ifdef FLUXINS_NO_EXCEPTIONS
+#define FLUXINS_THROW(exception) ::fluxins::terminate(exception)
+#else
+#define FLUXINS_THROW(exception) throw exception
+#endif
+
 namespace fluxins {
 
+/// Print the message of the exception and terminate, for builds without
+/// exceptions.
+[[noreturn]] void terminate(const std::exception &exception);
+
 /// A way to point to part of the expression.
 /// Yes, location can span multiple lines.
 struct code_location {
@@ -46,6 +65,108 @@ struct code_location {
     std::string preview_text(const code &expr, int padding = 0) const;
 };
 
+/// Kind of an error in the code, by the subclass of `code_error` it is thrown
+/// as.
+enum class error_kind {
+    code_error,           ///< `code_error`.
+    invalid_arity,        ///< `invalid_arity`.
+    tokenizer_error,      ///< `tokenizer_error`.
+    unexpected_token,     ///< `unexpected_token`.
+    unresolved_reference, ///< `unresolved_reference`.
+    exception,            ///< Exception other than `code_error` (such as thrown by a function), without location.
+    max
+};
+
+/// Converts error kind to string for debugging.
+std::string error_kind_to_string(error_kind kind);
+
+struct code_error; // FWD
+struct token;      // FWD
+
+/// Error in the code, without a copy of the code and the formatted message.
+///
+/// This is what the non-throwing functions (`try_*`) report instead of
+/// throwing `code_error`. The message is only formatted with the location in
+/// the code when requested.
+///
+/// Besides the message, the error carries the details of its kind, which are
+/// copied to the fields of the subclass of `code_error` when thrown.
+struct error_info {
+    error_kind    kind = error_kind::code_error; ///< Kind of the error.
+    std::string   message;                       ///< Message of the error.
+    code_location location;                      ///< Location in the code that caused the error.
+
+    std::string symbol;         ///< Name of the unresolved reference, or the function with invalid arity.
+    std::string symbol_type;    ///< Type of the unresolved reference (e.g., "variable", "function", "operator").
+    std::size_t args_count = 0; ///< Number of arguments the function was called with, for invalid arity.
+    std::size_t arity      = 0; ///< Number of arguments the function expects, for invalid arity.
+
+    /// Token that was found unexpectedly, for unexpected token.
+    std::shared_ptr<token> unexpected;
+
+    /// Get the error message formatted with the location and preview text of
+    /// the code, same as `code_error::what()`.
+    std::string format(const code &expr) const;
+
+    /// Throw the error as the subclass of `code_error` of its kind, or
+    /// terminate when built without exceptions.
+    [[noreturn]] void raise(const code &expr) const;
+
+    /// Create the error of an exception.
+    static error_info from(const code_error &error);
+
+    /// Create the error for a function called with invalid number of
+    /// arguments.
+    static error_info arity_mismatch(std::string_view function, std::size_t args_count, std::size_t arity, code_location location);
+
+    /// Create the error for an unresolved reference to a symbol.
+    static error_info unresolved(std::string_view symbol, std::string_view type, code_location location);
+
+    /// Create the error for an unexpected token.
+    static error_info unexpected_at(std::string_view message, const token &unexpected);
+};
+
+/// Collects the errors in the code reported on this thread (see
+/// `report_error()`) instead of throwing them, for as long as it is alive.
+///
+/// Only the first error is collected. Sinks can be nested, the innermost sink
+/// collects the errors.
+struct error_sink {
+    std::optional<error_info> error;              ///< First error reported while the sink was active.
+    error_sink               *previous = nullptr; ///< Sink that was active before this sink.
+
+    error_sink();
+    ~error_sink();
+
+    error_sink(const error_sink &)            = delete;
+    error_sink &operator=(const error_sink &) = delete;
+
+    /// Get the innermost active sink on this thread, or nullptr if none.
+    static error_sink *active();
+};
+
+/// Report an error in the code.
+///
+/// When an `error_sink` is active, the error is collected and NaN is returned
+/// for the evaluation to continue with. Otherwise the error is thrown as the
+/// subclass of `code_error` of its kind (or terminates when built without
+/// exceptions).
+///
+/// Operators and functions should report errors through this function (e.g.
+/// `return fluxins::report_error({ .message = "Division by zero", .location = location }, expr);`)
+/// so that the non-throwing functions do not need to unwind exceptions.
+float report_error(error_info error, const code &expr);
+
+/// Call the function with the errors in the code collected instead of thrown.
+///
+/// Exceptions thrown by the function (such as from functions that throw
+/// `code_error` instead of reporting it) are caught as well, unless built
+/// without exceptions.
+///
+/// @return Result of the function, or the first error reported.
+template <typename function_type>
+auto collect_errors(function_type &&function) -> std::expected<std::invoke_result_t<function_type>, error_info>;
+
 /// Error within the code, also contains details about the error and location of
 /// the error in the code.
 ///
@@ -70,9 +191,15 @@ struct code_error : std::exception {
 
     std::string formatted_message; ///< Stores the formatted message (for `what()`).
 
+    /// Kind of the error, by the subclass of the exception.
+    error_kind kind = error_kind::code_error;
+
     /// Initializes the exception. Also creates the formatted message.
     code_error(std::string_view message, const code &expr, code_location location);
 
+    /// Initializes the exception from the error.
+    code_error(const error_info &error, const code &expr);
+
     /// Obtain the error message (formatted).
     const char *what() const noexcept override
     {
@@ -87,10 +214,11 @@ struct code_error : std::exception {
 /// got invalid number of arguments.
 struct invalid_arity : code_error {
     std::string function;   ///< Name of the function that is throwing this exception.
-    std::size_t args_count; ///< Number of arguments the function was called with.
-    std::size_t arity;      ///< Number of arguments the function expects.
+    std::size_t args_count = 0; ///< Number of arguments the function was called with.
+    std::size_t arity      = 0; ///< Number of arguments the function expects.
 
     invalid_arity(std::string_view function, std::size_t args_count, std::size_t arity, const code &expr, code_location location);
+    invalid_arity(const error_info &error, const code &expr);
 };
 
 /// Subclass of `code_error` for errors from the tokenizer (lexer), related to
@@ -100,9 +228,10 @@ struct invalid_arity : code_error {
 /// that the tokenizer cannot handle.
 struct tokenizer_error : code_error {
     tokenizer_error(std::string_view message, const code &expr, code_location location);
+    tokenizer_error(const error_info &error, const code &expr);
 };
 
-struct token; // FWD
+struct packed_token; // FWD
 
 /// Subclass of `code_error` for errors from the parser, related to unexpected
 /// tokens while parsing.
@@ -115,6 +244,8 @@ struct unexpected_token : code_error {
     std::shared_ptr<token> unexpected;
 
     unexpected_token(std::string_view message, const code &expr, const token &unexpected);
+    unexpected_token(std::string_view message, const code &expr, const packed_token &unexpected);
+    unexpected_token(const error_info &error, const code &expr);
 };
 
 /// Subclass of `code_error` for errors from the evaluator, related to
@@ -127,6 +258,35 @@ struct unresolved_reference : code_error {
     std::string type;   ///< Type of the unresolved reference (e.g., "variable", "function", "operator").
 
     unresolved_reference(std::string_view symbol, std::string_view type, const code &expr, code_location location);
+    unresolved_reference(const error_info &error, const code &expr);
 };
 
+template <typename function_type>
+auto collect_errors(function_type &&function) -> std::expected<std::invoke_result_t<function_type>, error_info>
+{
+    error_sink sink;
+
+#ifndef FLUXINS_NO_EXCEPTIONS
+    try
+    {
+#endif
+        auto result = function();
+        if (sink.error)
+        {
+            return std::unexpected(std::move(*sink.error));
+        }
+        return result;
+#ifndef FLUXINS_NO_EXCEPTIONS
+    }
+    catch (const code_error &e)
+    {
+        return std::unexpected(error_info::from(e));
+    }
+    catch (const std::exception &e)
+    {
+        return std::unexpected(error_info { .kind = error_kind::exception, .message = e.what() });
+    }
+#endif
+}
+
 } // namespace fluxins
@@ -10,18 +10,32 @@
 
 #pragma once
 
+#include <cstddef>
+#include <expected>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "fluxins/batch.hpp"
+#include "fluxins/bytecode.hpp"
 #include "fluxins/code.hpp"
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/jit.hpp"
 #include "fluxins/parser.hpp"
 
 namespace fluxins {
 
+/// Variable read by an expression, with its value at the last evaluation.
+struct variable_dependency {
+    std::string             name;             ///< Name of the variable.
+    const fluxins_variable *handle = nullptr; ///< Variable in the context, `nullptr` when missing (see `context::bind_variable()`).
+    fluxins_variable        value  = 0.0f;    ///< Value of the variable at the last evaluation.
+};
+
 /// Fluxins expression.
 ///
 /// Provided an expression, this class stores expression as string as is, and
@@ -54,7 +68,7 @@ struct expression {
     /// Cached tokens after parsing.
     ///
     /// This is just here for debugging purposes.
-    std::vector<token> tokens;
+    std::vector<packed_token> tokens;
 
     /// Cached AST after parsing. This helps avoid re-parsing the expression
     /// when nothing has changed.
@@ -63,6 +77,20 @@ struct expression {
     /// `evaluate()` to update the cached value.
     std::shared_ptr<ast_node> ast;
 
+    /// Cached bytecode after compiling. When present, `evaluate()` executes
+    /// the bytecode instead of walking the AST.
+    ///
+    /// Remember to call `compile()` after parsing the expression or modifying
+    /// the config, otherwise the AST is evaluated instead.
+    bytecode program;
+
+    /// Cached native code after compiling natively. When present, `evaluate()`
+    /// executes the native code instead of the bytecode.
+    ///
+    /// Remember to call `compile_native()` after parsing the expression or
+    /// modifying the config, otherwise the bytecode or AST is evaluated instead.
+    std::shared_ptr<native_code> native;
+
     /// Cached value after evaluation. This helps avoid re-evaluating the
     /// expression when nothing has changed.
     ///
@@ -70,16 +98,144 @@ struct expression {
     /// expression or parent contexts.
     float value = 0.0f;
 
+    /// Variables read by the expression, with their values at the last
+    /// evaluation. Recorded by `evaluate()`, see `outdated()`.
+    std::vector<variable_dependency> dependencies;
+
+    /// True when the expression calls a function that is not pure (see
+    /// `function_traits`), the expression is then always outdated.
+    bool impure = false;
+
+    /// Context the dependencies were recorded for, `nullptr` when they were
+    /// not recorded since parsing, optimizing, compiling or binding.
+    const context *tracked_ctx = nullptr;
+
+    /// Revision of the context when the dependencies were recorded, see
+    /// `context::revision()`.
+    std::size_t tracked_revision = 0;
+
+    /// Epoch of the contexts when the revision was last compared (see
+    /// `context_epoch()`), the revision is only computed again after any
+    /// context has changed structurally.
+    std::size_t tracked_epoch = 0;
+
+    /// True when the cached AST was optimized since parsing (see
+    /// `optimize()`).
+    bool optimized = false;
+
+    /// Context the cached AST was optimized with (see `optimize()`).
+    const context *optimized_ctx = nullptr;
+
+    /// Epoch of the contexts when the functions the cached AST was optimized
+    /// with were last known to be current (see `context_epoch()`). The
+    /// expression is optimized again before evaluating when the functions have
+    /// changed since then.
+    std::size_t optimized_epoch = 0;
+
+    /// Context the cached AST and bytecode were bound to (see `bind()`),
+    /// `nullptr` when they were not bound since parsing.
+    const context *bound_ctx = nullptr;
+
+    /// Epoch of the contexts when the bound symbols were last known to be
+    /// current (see `context_epoch()`). The expression is bound again before
+    /// evaluating when the context has changed structurally since then.
+    std::size_t bound_epoch = 0;
+
     /// Parse the expression into cached AST.
     ///
+    /// Expressions parsed before from the same text with the same config are
+    /// copied from the cache of parsed expressions (see `global_cache()`).
+    ///
     /// @exception code_error Thrown when syntactical error occurs during parsing.
     void parse();
 
-    /// Evaluate the cached AST into cached value.
+    /// Fold constant subexpressions and eliminate common subexpressions of the
+    /// cached AST.
+    ///
+    /// @see `fold_constants()` and `eliminate_common_subexpressions()` for
+    ///      more information.
+    ///
+    /// The context is created if it is absent (nullptr).
+    ///
+    /// @note Folding uses the operators in the config and the pure functions in
+    ///       the context at the time of calling. Remember to call `parse()`
+    ///       again when modifying the config. The expression is optimized
+    ///       again from the parsed AST by `evaluate()` when the functions are
+    ///       modified (see `context::function_revision()`).
+    void optimize();
+
+    /// Compile the cached AST into cached bytecode.
+    ///
+    /// @exception code_error Thrown when an operator cannot be found in the config.
+    void compile();
+
+    /// Compile the cached bytecode into native code.
+    ///
+    /// The expression is compiled into bytecode first if it was not. When
+    /// native compilation is not supported on the platform, the bytecode is
+    /// used instead.
+    ///
+    /// @exception code_error Thrown when an operator cannot be found in the config.
+    void compile_native();
+
+    /// Bind the variables referenced by the cached AST and bytecode (if
+    /// compiled) to the variables in the context, which are then read without
+    /// looking them up by name.
+    ///
+    /// Remember to call `bind()` again after parsing, optimizing or compiling
+    /// the expression. Bound variables can be updated in-place, and the
+    /// expression is bound again by `evaluate()` when symbols are added to or
+    /// removed from the context or its parent contexts (see
+    /// `context::revision()`).
+    ///
+    /// @see `context::bind_variable()` for more information.
+    void bind();
+
+    /// Evaluate the cached AST into cached value, and record the variables it
+    /// reads. Nothing is done when the cached value is up to date (see
+    /// `outdated()`), so that only expressions reading modified variables are
+    /// evaluated again.
+    ///
+    /// An optimized expression is optimized (and compiled) again first when
+    /// the functions have changed since optimizing, so that folded calls are
+    /// never stale. A bound expression is bound again when the context or its
+    /// revision has changed since binding, so that symbols shadowed, removed
+    /// or added later are never read through stale handles.
+    ///
+    /// @note Variables are compared by value, they can be modified in any way.
+    ///       Remember to call `context::modified()` when assigning functions or
+    ///       modifying the parent contexts directly.
     ///
     /// @exception code_error Thrown when a referenced symbol is missing.
     void evaluate();
 
+    /// Check if evaluating the expression may change the cached value.
+    ///
+    /// The expression is outdated when it was not evaluated since parsing,
+    /// optimizing, compiling or binding, when the context or its revision has
+    /// changed (see `context::revision()`), when it calls an impure function,
+    /// or when a variable it reads has a different value.
+    bool outdated() const;
+
+    /// Evaluate the cached AST into cached value, without throwing.
+    ///
+    /// The cached value is left untouched when an error occurs.
+    ///
+    /// @return Value, or the first error reported during evaluation.
+    std::expected<float, error_info> try_evaluate();
+
+    /// Evaluate the expression for each row of the columns.
+    ///
+    /// The expression is compiled into bytecode first if it was not. The
+    /// cached value is left untouched.
+    ///
+    /// @see `execute_batch()` for more information.
+    ///
+    /// @exception std::invalid_argument Thrown when a column has less values
+    ///            than the number of rows.
+    /// @exception code_error Thrown when a referenced symbol is missing.
+    void evaluate_batch(std::span<const column> columns, std::span<float> output);
+
     /// Conversion operator to `float` type for ease of use.
     operator float()
     {
@@ -94,17 +250,28 @@ struct expression {
 
     /// Obtain the value of the expression.
     ///
-    /// This function will call parse() and evaluate() once.
+    /// This function will call parse(), optimize(), compile(), bind() and
+    /// evaluate() once.
     float get_value()
     {
         if (!ast)
         {
             parse();
+            optimize();
+            compile();
+            bind();
             evaluate();
         }
         return value;
     }
 
+    /// Obtain the value of the expression, without throwing.
+    ///
+    /// Same as `get_value()`, but the first error that occurs is returned
+    /// instead of thrown. The cached AST is discarded when an error occurs, so
+    /// the expression is prepared again on the next call.
+    std::expected<float, error_info> try_get_value();
+
     /// Set a variable to this expression's context.
     ///
     /// This will also create a context if it is absent (nullptr).
@@ -118,16 +285,19 @@ struct expression {
         return *this;
     }
 
-    /// Set a function to this expression's context.
+    /// Set a function to this expression's context, with its traits.
     ///
     /// This will also create a context if it is absent (nullptr).
-    expression &set_function(const std::string &name, const fluxins_function &function)
+    expression &set_function(
+        const std::string      &name,
+        const fluxins_function &function,
+        const function_traits  &properties = {})
     {
         if (!ctx)
         {
             ctx = std::make_shared<context>();
         }
-        ctx->set_function(name, function);
+        ctx->set_function(name, function, properties);
         return *this;
     }
 
@@ -145,10 +315,121 @@ struct expression {
     }
 };
 
+/// Expression compiled once and evaluated from any number of threads at the
+/// same time.
+///
+/// Unlike `expression`, the compiled expression holds no context and caches
+/// no value, each evaluation is provided with the variables (and the context
+/// for the functions and the other variables) and returns the value. The
+/// compiled expression is shared as `std::shared_ptr<const compiled_expression>`
+/// (see `compile_expression()`) and never modified after compiling. Each
+/// thread reuses its own stack for evaluating.
+///
+/// @note The compiled expression is only valid for the config it was compiled
+///       with. Remember to compile again when modifying the config.
+/// @note Evaluating is thread safe as long as the config, the context and the
+///       functions are not modified at the same time.
+struct compiled_expression {
+    code                    expr;    ///< Code the expression was compiled from (for error reporting).
+    std::shared_ptr<config> cfg;     ///< Config the expression was compiled with.
+    bytecode                program; ///< Optimized, unbound bytecode of the expression.
+
+    /// Names of the variables read by the expression, in the order of the
+    /// values passed to `evaluate()`.
+    std::vector<std::string> variables;
+
+    /// Index in `variables` of each name in the bytecode, `(std::size_t) -1`
+    /// for the names of functions.
+    std::vector<std::size_t> variable_indices;
+
+    /// Values of the variables the expression was specialized for (see
+    /// `specialize_expression()`), which are not read by the expression.
+    fluxins_variables constants;
+
+    /// Get the index of the variable in `variables`.
+    /// @return Index of the variable, or `(std::size_t) -1` if the expression
+    ///         does not read the variable.
+    std::size_t find_variable(std::string_view name) const;
+
+    /// Evaluate the expression with the variables and functions looked up in
+    /// the context (which may be `nullptr`).
+    /// @exception code_error Thrown when a referenced symbol is missing.
+    float evaluate(const context *ctx) const;
+
+    /// Evaluate the expression with the values of the variables, in the order
+    /// of `variables`. Variables without values (when there are less values
+    /// than variables) and functions are looked up in the context (which may
+    /// be `nullptr`).
+    /// @exception code_error Thrown when a referenced symbol is missing.
+    float evaluate(std::span<const float> values, const context *ctx = nullptr) const;
+
+    /// Evaluate the expression, without throwing.
+    /// @return Value, or the first error reported during evaluation.
+    std::expected<float, error_info> try_evaluate(const context *ctx) const;
+
+    /// Evaluate the expression with the values of the variables, without
+    /// throwing.
+    /// @return Value, or the first error reported during evaluation.
+    std::expected<float, error_info> try_evaluate(std::span<const float> values, const context *ctx = nullptr) const;
+
+    /// Specialize the expression further for the constant values of more
+    /// variables, see `specialize_expression()`.
+    /// @return Specialized expression, or `nullptr` when an error was
+    ///         collected (see `error_sink`).
+    std::shared_ptr<const compiled_expression> specialize(
+        const fluxins_variables &values,
+        std::shared_ptr<context> ctx = nullptr) const;
+};
+
+/// Compile the expression for evaluating from multiple threads.
+///
+/// The expression is parsed (see `global_cache()`), optimized and compiled
+/// into bytecode. The context is only used to fold calls to pure functions,
+/// and may be `nullptr`.
+///
+/// @exception code_error Thrown when syntactical error occurs during parsing,
+///            or when an operator cannot be found in the config.
+std::shared_ptr<const compiled_expression> compile_expression(
+    const code              &expr,
+    std::shared_ptr<config>  cfg = nullptr,
+    std::shared_ptr<context> ctx = nullptr);
+
+/// Compile the expression for evaluating from multiple threads, specialized
+/// for the constant values of some of its variables.
+///
+/// The variables with constant values are replaced by the values before
+/// optimizing (see `substitute_variables()`), so that the subexpressions
+/// depending only on them are folded away. The specialized expression only
+/// reads the other variables (see `compiled_expression::variables`), and is
+/// compiled again when the constant values change.
+///
+/// @see `compile_expression()` for more information.
+///
+/// @exception code_error Thrown when syntactical error occurs during parsing,
+///            or when an operator cannot be found in the config.
+std::shared_ptr<const compiled_expression> specialize_expression(
+    const code              &expr,
+    const fluxins_variables &constants,
+    std::shared_ptr<config>  cfg = nullptr,
+    std::shared_ptr<context> ctx = nullptr);
+
 /// Evaluate an expression with the given configuration and context.
-inline float express(std::string_view expr, std::shared_ptr<fluxins::config> cfg = nullptr, std::shared_ptr<fluxins::context> ctx = nullptr)
-{
-    return fluxins::expression(expr, cfg, ctx).get_value();
-}
+///
+/// The expression is evaluated once, so it is parsed (or found in the cache of
+/// parsed expressions, see `global_cache()`) and its AST is evaluated
+/// directly, without optimizing, compiling or binding it. No context is
+/// created when none is provided, and the code is only named when an error is
+/// reported. Use `expression` to evaluate the expression repeatedly.
+///
+/// @exception code_error Thrown when invalid expression was provided.
+float express(std::string_view expr, std::shared_ptr<fluxins::config> cfg = nullptr, std::shared_ptr<fluxins::context> ctx = nullptr);
+
+/// Evaluate an expression with the given configuration and context, without
+/// throwing.
+///
+/// @see `express()` for more information.
+///
+/// @return Value, or the first error that occurs.
+std::expected<float, error_info> try_express(std::string_view expr, std::shared_ptr<fluxins::config> cfg = nullptr, std::shared_ptr<fluxins::context> ctx = nullptr);
 
 } // namespace fluxins
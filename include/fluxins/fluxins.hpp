@@ -14,9 +14,17 @@
 
 #pragma once
 
-#include "fluxins/code.hpp"       // IWYU pragma: export
-#include "fluxins/config.hpp"     // IWYU pragma: export
-#include "fluxins/context.hpp"    // IWYU pragma: export
-#include "fluxins/error.hpp"      // IWYU pragma: export
-#include "fluxins/expression.hpp" // IWYU pragma: export
-#include "fluxins/parser.hpp"     // IWYU pragma: export
+#include "fluxins/batch.hpp"       // IWYU pragma: export
+#include "fluxins/bytecode.hpp"    // IWYU pragma: export
+#include "fluxins/cache.hpp"       // IWYU pragma: export
+#include "fluxins/code.hpp"        // IWYU pragma: export
+#include "fluxins/config.hpp"      // IWYU pragma: export
+#include "fluxins/context.hpp"     // IWYU pragma: export
+#include "fluxins/error.hpp"       // IWYU pragma: export
+#include "fluxins/expression.hpp"  // IWYU pragma: export
+#include "fluxins/graph.hpp"       // IWYU pragma: export
+#include "fluxins/jit.hpp"         // IWYU pragma: export
+#include "fluxins/optimizer.hpp"   // IWYU pragma: export
+#include "fluxins/parallel.hpp"    // IWYU pragma: export
+#include "fluxins/parser.hpp"      // IWYU pragma: export
+#include "fluxins/vector_math.hpp" // IWYU pragma: export
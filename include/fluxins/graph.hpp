@@ -0,0 +1,130 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides a graph of named expressions reading the values
+/// of each other, evaluated in topological order.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parallel.hpp"
+#include "fluxins/parser.hpp"
+
+namespace fluxins {
+
+/// Named expression in the graph, whose value is a variable that the other
+/// nodes can read.
+struct graph_node {
+    std::string name;    ///< Name of the node, and the variable holding its value.
+    expression  expr;    ///< Expression of the node, evaluated with the context of the graph.
+    ast_symbols symbols; ///< Symbols referenced by the expression.
+
+    std::vector<graph_node *> inputs;  ///< Nodes read by the expression.
+    std::vector<graph_node *> outputs; ///< Nodes reading the value of this node.
+
+    /// Level of the node, zero when the node reads no nodes, and otherwise one
+    /// more than the highest level of the nodes it reads. Nodes of the same
+    /// level do not depend on each other.
+    std::size_t level = 0;
+
+    /// Variable in the context of the graph holding the value of the node.
+    fluxins_variable *slot = nullptr;
+};
+
+/// Graph of named expressions whose variables may refer to the other nodes,
+/// like cells of a spreadsheet.
+///
+/// The value of each node is a variable of the graph's context, so the
+/// expressions read the values of the other nodes like any other variable.
+/// Variables that are not nodes (the inputs) are read from the context or its
+/// parent contexts. Cycles are rejected when a node is set, and the level of
+/// each node (see `graph_node::level`) is kept up to date as nodes are set and
+/// removed, only for the nodes downstream of the change.
+///
+/// `evaluate()` evaluates the nodes level by level, the nodes of one level in
+/// parallel. Nodes are only evaluated when a variable they read has changed
+/// (see `expression::outdated()`), so after modifying an input only the nodes
+/// downstream of the input are evaluated again.
+///
+/// @note Functions called by the nodes may be called from multiple threads at
+///       the same time.
+struct expression_graph {
+    /// Configuration for parsing the expressions. If `nullptr`, it will use
+    /// default configuration.
+    ///
+    /// Remember to set the nodes again when modifying the config.
+    std::shared_ptr<config> cfg;
+
+    /// Context holding the values of the nodes and the inputs (directly or
+    /// through the parent contexts).
+    std::shared_ptr<context> ctx;
+
+    /// Nodes by name.
+    /// @note Remember to use `set_node()` and `remove_node()` instead of
+    ///       modifying the nodes directly.
+    std::unordered_map<std::string, graph_node> nodes;
+
+    /// Nodes of each level, rebuilt by `evaluate()` when the levels have
+    /// changed.
+    std::vector<std::vector<graph_node *>> levels;
+
+    /// True when the levels have to be rebuilt.
+    bool levels_outdated = true;
+
+    /// Creates the graph with the config and context (a new context is
+    /// created when `nullptr`).
+    expression_graph(std::shared_ptr<config> cfg = nullptr, std::shared_ptr<context> ctx = nullptr);
+
+    // Nodes point to each other
+    expression_graph(const expression_graph &)            = delete;
+    expression_graph &operator=(const expression_graph &) = delete;
+
+    /// Set the expression of the node, adding the node when it does not
+    /// exist. The variable of the same name in the context is replaced by the
+    /// value of the node.
+    ///
+    /// The graph is left unchanged when an exception is thrown.
+    ///
+    /// @exception code_error Thrown when syntactical error occurs during parsing.
+    /// @exception std::logic_error Thrown when the node would depend on itself.
+    graph_node &set_node(const std::string &name, const code &expr);
+
+    /// Remove the node and its variable from the context. Nodes reading the
+    /// node read the variable of the same name from the context instead.
+    /// @exception std::invalid_argument Thrown when the node does not exist.
+    void remove_node(const std::string &name);
+
+    /// Get the node.
+    /// @return The node, or `nullptr` when the node does not exist.
+    graph_node *find_node(const std::string &name);
+
+    /// Get the value of the node from the last evaluation.
+    /// @exception std::invalid_argument Thrown when the node does not exist.
+    float get_value(const std::string &name) const;
+
+    /// Assigns or inserts an input variable to the context of the graph.
+    /// @exception std::logic_error Thrown when the name is a node.
+    expression_graph &set_input(const std::string &name, const fluxins_variable &variable);
+
+    /// Evaluate the outdated nodes level by level, the nodes of one level in
+    /// parallel on the pool.
+    /// @return Number of nodes evaluated.
+    /// @exception code_error Thrown when a referenced symbol is missing (the
+    ///            error of the first failing node of the first failing level).
+    std::size_t evaluate(thread_pool &pool = default_pool());
+};
+
+} // namespace fluxins
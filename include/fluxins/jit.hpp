@@ -0,0 +1,64 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides native (just-in-time) compilation of bytecode
+/// into machine code. Only x86-64 with System V calling convention is
+/// supported, other platforms fall back to the bytecode interpreter.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+
+namespace fluxins {
+
+/// Machine code compiled from bytecode, stored in executable memory pages.
+///
+/// Operators with a known `intrinsic` are lowered into native instructions,
+/// other operators, variables and functions are handled by direct calls into
+/// the library.
+///
+/// @note The native code is only valid for the bytecode and the version of
+///       the config it was compiled with, executing it with a modified config
+///       reports an error. Remember to recompile it when either changes.
+struct native_code {
+    void       *memory  = nullptr; ///< Executable memory.
+    std::size_t size    = 0;       ///< Size of the executable memory.
+    std::size_t version = 0;       ///< Version of the config the code was compiled with (see `config::version`).
+
+    native_code() = default;
+    ~native_code();
+
+    native_code(const native_code &)            = delete;
+    native_code &operator=(const native_code &) = delete;
+};
+
+/// Returns true when native compilation is supported on this platform.
+bool jit_supported();
+
+/// Compile the bytecode into native machine code.
+/// @return `nullptr` when native compilation is not supported.
+std::shared_ptr<native_code> jit_compile(
+    const bytecode         &program,
+    std::shared_ptr<config> cfg);
+
+/// Execute the native code for value.
+/// @exception code_error Thrown when a referenced symbol is missing, or the
+///            config was modified after compiling.
+float jit_execute(
+    const native_code       &native,
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx);
+
+} // namespace fluxins
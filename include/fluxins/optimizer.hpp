@@ -0,0 +1,71 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides optimization passes over the AST.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <memory>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/parser.hpp"
+
+namespace fluxins {
+
+/// Fold constant subexpressions of the AST.
+///
+/// Operators whose operands are all numbers are evaluated once and replaced by
+/// a number, using the operators in the config. Conditionals with a constant
+/// condition are replaced by the branch that would be taken.
+///
+/// Calls to pure functions (see `function_traits`) in the context whose
+/// arguments are all numbers are folded as well. Impure functions are never
+/// folded as they may not return the same value each call, and no functions
+/// are folded when the context is `nullptr`.
+///
+/// Operators and functions that throw (e.g. division by zero) are left as they
+/// are so that the error is reported when the expression is evaluated.
+///
+/// @return The folded AST, which may be the same node as `ast`.
+std::shared_ptr<ast_node> fold_constants(
+    const code               &expr,
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<config>   cfg,
+    std::shared_ptr<context>  ctx = nullptr);
+
+/// Replace the variables of the AST that have constant values with numbers,
+/// so that the subexpressions depending only on them can be folded (see
+/// `fold_constants()`).
+///
+/// @note The AST is modified in-place, remember to `clone()` shared ASTs.
+///
+/// @return The AST with the variables replaced, which may be the same node as
+///         `ast`.
+std::shared_ptr<ast_node> substitute_variables(
+    std::shared_ptr<ast_node> ast,
+    const fluxins_variables  &constants);
+
+/// Eliminate common subexpressions of the AST.
+///
+/// Structurally equal subexpressions (see `ast_node::equals()`) are merged
+/// into one node, turning the AST into a DAG. Merged nodes with multiple
+/// parents are wrapped in `shared_ast`, which compiled bytecode computes once
+/// per evaluation. Subexpressions calling impure functions (or any functions
+/// when the context is `nullptr`) are not merged as the functions may not
+/// return the same value each call.
+///
+/// @note Evaluating the AST directly (without compiling) still evaluates the
+///       shared subexpressions for every parent.
+///
+/// @return The AST with shared subexpressions.
+std::shared_ptr<ast_node> eliminate_common_subexpressions(
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<context>  ctx = nullptr);
+
+} // namespace fluxins
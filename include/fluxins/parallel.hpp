@@ -0,0 +1,143 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides a work-stealing thread pool and evaluating many
+/// compiled expressions in parallel.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "fluxins/context.hpp"
+#include "fluxins/expression.hpp"
+
+namespace fluxins {
+
+/// Options of the thread pool.
+struct pool_options {
+    /// Number of threads evaluating, including the thread waiting for the
+    /// evaluation. Zero for the number of hardware threads.
+    std::size_t threads = 0;
+
+    /// Number of items each thread takes at a time. Zero to split the items
+    /// into a few chunks for each thread.
+    std::size_t chunk_size = 0;
+
+    /// Pin each thread of the pool to one processor (only supported on Linux,
+    /// ignored on other platforms).
+    bool pin_threads = false;
+};
+
+/// Range of items to be processed by a thread of the pool.
+struct pool_chunk {
+    const std::function<void(std::size_t, std::size_t)> *function = nullptr; ///< Function processing the items.
+
+    std::size_t begin = 0; ///< First item.
+    std::size_t end   = 0; ///< Past the last item.
+};
+
+/// Chunks waiting to be processed by a thread of the pool, other threads take
+/// chunks from it when they run out of their own chunks.
+struct pool_queue {
+    std::mutex             mutex;  ///< Guards the chunks.
+    std::deque<pool_chunk> chunks; ///< Chunks waiting to be processed.
+};
+
+/// Pool of threads processing chunks of items, where threads that run out of
+/// chunks steal chunks from the other threads.
+///
+/// The thread calling `parallel_for()` processes chunks as well, and the pool
+/// runs one `parallel_for()` at a time.
+struct thread_pool {
+    pool_options options; ///< Options the pool was created with.
+
+    /// Queue of each thread, the last queue belongs to the thread calling
+    /// `parallel_for()`.
+    std::vector<std::unique_ptr<pool_queue>> queues;
+
+    std::vector<std::thread> workers; ///< Threads of the pool.
+
+    std::mutex              mutex;              ///< Guards the state below.
+    std::condition_variable wake;               ///< Notifies the threads that chunks are queued or the pool is stopping.
+    std::condition_variable finished;           ///< Notifies the calling thread that all the chunks are processed.
+    std::size_t             generation = 0;     ///< Incremented whenever chunks are queued.
+    std::size_t             remaining  = 0;     ///< Number of chunks not processed yet.
+    bool                    stopping   = false; ///< True when the pool is being destroyed.
+
+    std::exception_ptr error;           ///< Exception thrown by the chunk with the first items.
+    std::size_t        error_begin = 0; ///< First item of the chunk that threw the exception.
+
+    /// Serializes the calls to `parallel_for()`.
+    std::mutex running;
+
+    /// Creates the pool and starts the threads.
+    thread_pool(const pool_options &options = {});
+
+    /// Stops and joins the threads.
+    ~thread_pool();
+
+    thread_pool(const thread_pool &)            = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /// Get the number of threads processing chunks, including the calling
+    /// thread.
+    std::size_t size() const
+    {
+        return queues.size();
+    }
+
+    /// Call the function for chunks of items from `0` to `count - 1` in
+    /// parallel, and wait for all the chunks to be processed.
+    ///
+    /// The function is called with the first item and past the last item of
+    /// the chunk. Calling `parallel_for()` from within the function processes
+    /// the items on the calling thread.
+    ///
+    /// @exception Rethrows the exception thrown by the function for the
+    ///            chunk with the first items, after all the chunks are processed.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)> &function);
+
+    /// Process the chunks of the queue, and of the other queues when it runs
+    /// out of chunks.
+    void process(std::size_t queue);
+};
+
+/// Get the pool used by default, created with the default options on first
+/// use.
+thread_pool &default_pool();
+
+/// Compiled expression to evaluate, with its variables and context.
+struct evaluation_task {
+    const compiled_expression *compiled = nullptr; ///< Expression to evaluate.
+    std::span<const float>     values;             ///< Values of the variables, see `compiled_expression::evaluate()`.
+    const context             *ctx      = nullptr; ///< Context of the other symbols (if any).
+};
+
+/// Evaluate the compiled expressions in parallel on the pool.
+///
+/// The value of `tasks[i]` is written to `output[i]`, the values do not depend
+/// on how the tasks are scheduled.
+///
+/// @exception std::invalid_argument Thrown when the output has less values
+///            than the number of tasks.
+/// @exception code_error Thrown when a referenced symbol is missing (the
+///            error of the first task that failed).
+void evaluate_parallel(
+    std::span<const evaluation_task> tasks,
+    std::span<float>                 output,
+    thread_pool                     &pool = default_pool());
+
+} // namespace fluxins
@@ -11,11 +11,16 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <expected>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "fluxins/bytecode.hpp"
 #include "fluxins/code.hpp"
+#include "fluxins/compact_ast.hpp"
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
 #include "fluxins/error.hpp"
@@ -29,8 +34,11 @@ struct token {
         /// Identifier starts with a-z, A-Z and '_', and can be followed by any
         /// number of a-z, A-Z, 0-9 or '_'.
         identifier,
-        /// Number starts with 0-9 and can be followed by any number of 0-9 and `'`
-        /// and can contain at most one '.' (must be in between).
+        /// Number starts with 0-9 and can be followed by any number of 0-9, `'`
+        /// and `_` and can contain at most one '.', optionally followed by an
+        /// exponent (`e` or `E`, optional sign and 0-9). Hexadecimal number
+        /// starts with `0x` or `0X` followed by any number of 0-9, a-f, A-F,
+        /// `'` and `_`. Number cannot end with `'` or `_`.
         number,
         /// Operator can contain any number of `+`, `-`, `*`, `/`, `%`, `^`, `=`,
         /// `!`, `~`, `&`, `|`, `<`, `>`, `?`, `:`, `[` and `]`.
@@ -46,10 +54,49 @@ struct token {
     code_location location; ///< Token location.
 };
 
+/// A single token of the expression, packed into a small record that refers
+/// to the expression instead of holding a copy of the value.
+/// @note Packed tokens are only valid for the code they were tokenized from.
+struct packed_token {
+    token::token_type type   = token::token_type::max; ///< Token type.
+    std::uint32_t     begin  = 0;                      ///< Offset of the token in the expression.
+    std::uint32_t     length = 0;                      ///< Length of the token.
+
+    /// Get the value of the token (the token itself) from the expression.
+    std::string_view value(const code &expr) const
+    {
+        return std::string_view(expr.expr).substr(begin, length);
+    }
+
+    /// Get the location of the token.
+    code_location location() const
+    {
+        return { begin, length, 0 };
+    }
+
+    /// Get the token with a copy of its value from the expression.
+    token unpack(const code &expr) const
+    {
+        return { .type = type, .value = std::string(value(expr)), .location = location() };
+    }
+};
+
 /// Tokenize the given expression string.
 /// @exception code_error Thrown when invalid token was provided.
 std::vector<token> tokenize(const code &expr);
 
+/// Tokenize the given expression string into packed tokens, without copying
+/// the value of any token.
+/// @exception code_error Thrown when invalid token was provided.
+std::vector<packed_token> tokenize_packed(const code &expr);
+
+/// Tokenize the given expression string into packed tokens, without throwing.
+/// @return Packed tokens, or the error when invalid token was provided.
+std::expected<std::vector<packed_token>, error_info> try_tokenize(const code &expr);
+
+/// Pack the tokens, dropping the copies of their values.
+std::vector<packed_token> pack_tokens(const std::vector<token> &tokens);
+
 /// Get the string representation of the token type for debugging.
 std::string token_type_to_string(token::token_type type);
 
@@ -59,20 +106,99 @@ std::string token_to_string(const code &expr, const token &tok);
 /// Get the string representation of the tokens for debugging.
 std::string tokens_to_string(const code &expr, const std::vector<token> &tokens);
 
+/// Get the string representation of the packed token for debugging.
+std::string token_to_string(const code &expr, const packed_token &tok);
+
+/// Get the string representation of the packed tokens for debugging.
+std::string tokens_to_string(const code &expr, const std::vector<packed_token> &tokens);
+
+/// Borrowed state for evaluating AST, passed down to every node without
+/// reference counting.
+/// @note The frame does not own anything, the code, config and context must
+///       outlive the evaluation.
+struct evaluation_frame {
+    const code    &expr;          ///< Code being evaluated (for error reporting).
+    const config  &cfg;           ///< Config with the operators.
+    const context *ctx = nullptr; ///< Context with the symbols (if any).
+};
+
+/// Names of the variables and functions referenced by AST, see
+/// `ast_node::collect_symbols()`.
+struct ast_symbols {
+    std::vector<std::string> variables; ///< Names of the variables, in the order they are first referenced.
+    std::vector<std::string> functions; ///< Names of the functions, in the order they are first referenced.
+};
+
 /// Abstract Syntax Tree's base node structure.
 struct ast_node {
-    code_location           location; ///< Location of the AST.
-    std::weak_ptr<ast_node> parent;   ///< Reference to parent of this node (if any).
+    code_location location; ///< Location of the AST.
 
     ast_node()          = default;
     virtual ~ast_node() = default;
 
     /// Evaluate this node (and children, if it contains any) for value.
     /// @exception code_error Thrown when invalid expression was provided.
-    virtual float evaluate(
+    virtual float evaluate(const evaluation_frame &frame) const = 0;
+
+    /// Evaluate this node (and children, if it contains any) for value.
+    ///
+    /// Convenience overload that borrows the config and context into an
+    /// evaluation frame once, nodes are evaluated with the frame.
+    ///
+    /// @exception code_error Thrown when invalid expression was provided.
+    float evaluate(
+        const code              &expr,
+        std::shared_ptr<config>  cfg,
+        std::shared_ptr<context> ctx) const;
+
+    /// Compile this node (and children, if it contains any) into bytecode.
+    /// @exception code_error Thrown when an operator cannot be found.
+    virtual void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const = 0;
+
+    /// Compact this node (and children, if it contains any) into the arena.
+    /// @return Index of the compacted node.
+    /// @exception code_error Thrown when an operator cannot be found.
+    virtual std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const = 0;
+
+    /// Fold constant subexpressions of this node (and children, if it contains
+    /// any), replacing the folded children.
+    ///
+    /// The context is used to resolve pure functions only, and may be
+    /// `nullptr` to leave all the functions unfolded.
+    /// @return The node replacing this node, or `nullptr` to keep this node.
+    virtual std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const = 0;
+        std::shared_ptr<context> ctx) = 0;
+
+    /// Bind the variables and functions referenced by this node (and
+    /// children, if it contains any) to the symbols in the context, see
+    /// `context::bind_variable()` and `context::bind_function()`. Bound
+    /// symbols are used without looking them up by name, symbols missing from
+    /// the context are left unbound.
+    virtual void bind(std::shared_ptr<context> ctx) = 0;
+
+    /// Add the names of the variables and functions referenced by this node
+    /// (and children, if it contains any) that are not in the symbols yet.
+    virtual void collect_symbols(ast_symbols &symbols) const = 0;
+
+    /// Copy this node and children, so that the copy can be optimized and
+    /// bound without modifying this node. The copy is unbound.
+    virtual std::shared_ptr<ast_node> clone() const = 0;
+
+    /// Structural hash of this node and children, equal for nodes that are
+    /// `equals()`.
+    virtual std::size_t hash() const = 0;
+
+    /// Check if this node and children are structurally equal to the other
+    /// node and its children (locations are not compared).
+    virtual bool equals(const ast_node &other) const = 0;
 
     /// Get the string representation of this node and children for debugging.
     virtual std::string to_string(const code &expr, int indent = 0) const = 0;
@@ -80,106 +206,188 @@ struct ast_node {
 
 /// Parse primary expression (initiates parsing of number, variable, function, etc.).
 std::shared_ptr<ast_node> parse_primary(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse numeric expression.
 std::shared_ptr<ast_node> parse_number(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse identifier expression (initiates parsing of variable and function).
 std::shared_ptr<ast_node> parse_identifier(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse variable expression.
 std::shared_ptr<ast_node> parse_variable(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse functional expression.
 std::shared_ptr<ast_node> parse_function(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse expression with parenthesis.
 std::shared_ptr<ast_node> parse_parenthesis(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
-/// Parse binary operator at precedence.
+/// Parse binary operators at precedence and above (more precedent).
+///
+/// Operators are parsed by precedence climbing, driven by the binding power
+/// of the operators (`config::binary_op_bindings`).
 std::shared_ptr<ast_node> parse_binary_op(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos,
-    std::size_t               prec);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos,
+    std::size_t                      prec);
 
 /// Parse conditional operator.
 std::shared_ptr<ast_node> parse_condition(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 std::shared_ptr<ast_node> parse_all(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos);
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos);
 
 /// Parse the tokens into AST.
+std::shared_ptr<ast_node> parse(
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg);
+
+/// Parse the tokens into AST.
+/// @note The tokens are packed before parsing, prefer `tokenize_packed`.
 std::shared_ptr<ast_node> parse(
     const code               &expr,
     const std::vector<token> &tokens,
     std::shared_ptr<config>   cfg);
 
+/// Parse the tokens into AST, without throwing.
+/// @return AST, or the error when syntactical error occurs during parsing.
+std::expected<std::shared_ptr<ast_node>, error_info> try_parse(
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg);
+
 /// AST node representing a number.
 struct number_ast : ast_node {
     float value; ///< Value of the number.
 
-    float evaluate(
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const override;
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
 
     std::string to_string(const code &expr, int indent = 0) const override;
 };
 
 /// AST node representing a variable.
 struct variable_ast : ast_node {
-    std::string name; ///< Name of the variable.
+    std::string       name;           ///< Name of the variable.
+    fluxins_variable *slot = nullptr; ///< Bound variable (if bound), see `bind()`.
 
-    float evaluate(
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const override;
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
 
     std::string to_string(const code &expr, int indent = 0) const override;
 };
 
 /// AST node representing a function call.
 struct function_ast : ast_node {
-    std::string                            name; ///< Name of the function.
-    std::vector<std::shared_ptr<ast_node>> args; ///< Function arguments.
+    std::string                            name;             ///< Name of the function.
+    std::vector<std::shared_ptr<ast_node>> args;             ///< Function arguments.
+    const fluxins_function                *target = nullptr; ///< Bound function (if bound), see `bind()`.
 
-    float evaluate(
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const override;
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
 
     std::string to_string(const code &expr, int indent = 0) const override;
 };
@@ -195,10 +403,51 @@ struct operator_ast : ast_node {
     std::shared_ptr<ast_node> left;  ///< Left operand.
     std::shared_ptr<ast_node> right; ///< Right operand.
 
-    float evaluate(
+    /// Index of the operator in the list of operators of the config (if
+    /// resolved), see `resolve()`.
+    std::size_t index = (std::size_t) -1;
+
+    const config *resolved_config  = nullptr; ///< Config that the index was resolved with.
+    std::size_t   resolved_version = 0;       ///< Version of the config that the index was resolved with.
+
+    /// Resolve the index of the operator in the list of operators of the
+    /// config. The parser resolves the operators it creates.
+    void resolve(const config &cfg);
+
+    /// Get the index of the operator in the list of operators of the config.
+    ///
+    /// The resolved index is used when the operator was resolved with the same
+    /// config and version (see `config::version`), otherwise the operator is
+    /// found by symbol.
+    ///
+    /// @return `(std::size_t) -1` when the operator does not exist.
+    std::size_t find(const config &cfg) const;
+
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const override;
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
 
     std::string to_string(const code &expr, int indent = 0) const override;
 };
@@ -209,10 +458,69 @@ struct conditional_ast : ast_node {
     std::shared_ptr<ast_node> true_value;  ///< Expression if condition is true.
     std::shared_ptr<ast_node> false_value; ///< Expression if condition is false.
 
-    float evaluate(
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
         const code              &expr,
         std::shared_ptr<config>  cfg,
-        std::shared_ptr<context> ctx) const override;
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
+
+    std::string to_string(const code &expr, int indent = 0) const override;
+};
+
+/// AST node representing a subexpression shared by multiple parents, which
+/// turns the AST into a DAG (see `eliminate_common_subexpressions()`).
+///
+/// Compiled bytecode computes the subexpression once and keeps the value in a
+/// local for the other parents.
+struct shared_ast : ast_node {
+    std::shared_ptr<ast_node> node;     ///< Shared subexpression.
+    std::uint32_t             slot = 0; ///< Local holding the value of the subexpression.
+
+    using ast_node::evaluate;
+    float evaluate(const evaluation_frame &frame) const override;
+
+    void compile(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        bytecode               &program) const override;
+
+    std::uint32_t compact(
+        const code             &expr,
+        std::shared_ptr<config> cfg,
+        compact_ast            &tree) const override;
+
+    std::shared_ptr<ast_node> fold(
+        const code              &expr,
+        std::shared_ptr<config>  cfg,
+        std::shared_ptr<context> ctx) override;
+
+    void bind(std::shared_ptr<context> ctx) override;
+    void collect_symbols(ast_symbols &symbols) const override;
+
+    std::shared_ptr<ast_node> clone() const override;
+
+    std::size_t hash() const override;
+    bool        equals(const ast_node &other) const override;
 
     std::string to_string(const code &expr, int indent = 0) const override;
 };
@@ -0,0 +1,76 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides vectorized math kernels, which evaluate a math
+/// function for many values at once.
+///
+/// The kernels process values in blocks of `simd::block_size` floats, with
+/// loops the compiler turns into SIMD instructions of the instruction set the
+/// library is compiled for (SSE2 at least on x86-64). With GCC on x86-64 Linux,
+/// the kernels are also compiled for AVX2 and AVX-512, selected at runtime for
+/// the processor. Whether the kernels are faster than the `<cmath>` functions
+/// depends on the width of the vectors, see `simd::wide_vectors()`.
+///
+/// Accuracy is given in ULPs (units in the last place) of the `float` result,
+/// compared to the exact result. Transcendental kernels are computed in double
+/// precision internally and rounded once, so their error is at most 1 ULP
+/// (almost always correctly rounded). Special values (NaN, infinity, zero and
+/// negative arguments) match the `<cmath>` functions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace fluxins::simd {
+
+/// Number of values processed by a kernel at once, the kernels process the
+/// values block by block.
+inline constexpr std::size_t block_size = 256;
+
+/// Whether the kernels run with vectors of at least 256 bits (AVX2 with FMA).
+///
+/// The trigonometric kernels, `tanh`, `sqrt` and `log10` are faster than the
+/// `<cmath>` functions with any vectors, the other kernels only with wide
+/// vectors.
+bool wide_vectors();
+
+// All the kernels compute `output[i] = function(x[i])` for every `i` in
+// `output`. The inputs must have at least as many values as the output, and the
+// output may be the same memory as an input.
+
+void ceil(std::span<const float> x, std::span<float> output);  ///< Round up, exact.
+void floor(std::span<const float> x, std::span<float> output); ///< Round down, exact.
+void trunc(std::span<const float> x, std::span<float> output); ///< Round toward zero, exact.
+void sqrt(std::span<const float> x, std::span<float> output);  ///< Square root, correctly rounded.
+
+void exp(std::span<const float> x, std::span<float> output);   ///< Base-e exponential, 1 ULP.
+void exp2(std::span<const float> x, std::span<float> output);  ///< Base-2 exponential, 1 ULP.
+void log(std::span<const float> x, std::span<float> output);   ///< Natural logarithm, 1 ULP.
+void log2(std::span<const float> x, std::span<float> output);  ///< Base-2 logarithm, 1 ULP.
+void log10(std::span<const float> x, std::span<float> output); ///< Base-10 logarithm, 1 ULP.
+
+/// Sine, 1 ULP.
+/// @note Arguments beyond ±65536 are computed with `std::sin`.
+void sin(std::span<const float> x, std::span<float> output);
+
+/// Cosine, 1 ULP.
+/// @note Arguments beyond ±65536 are computed with `std::cos`.
+void cos(std::span<const float> x, std::span<float> output);
+
+/// Tangent, 1 ULP.
+/// @note Arguments beyond ±65536 are computed with `std::tan`.
+void tan(std::span<const float> x, std::span<float> output);
+
+void tanh(std::span<const float> x, std::span<float> output); ///< Hyperbolic tangent, 1 ULP.
+
+/// Power (`x` raised to `y`), 1 ULP.
+/// @note Non-positive or non-finite `x` and non-finite `y` are computed with
+///       `std::pow`.
+void pow(std::span<const float> x, std::span<const float> y, std::span<float> output);
+
+} // namespace fluxins::simd
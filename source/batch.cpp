@@ -0,0 +1,386 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for batched bytecode execution.
+///
+/// The stack of a block is laid out slot by slot, every slot holds the values
+/// of all the rows of the block (`stack[slot * stride + row]`).
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fluxins/batch.hpp"
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+
+/// Symbols resolved once for the whole batch.
+struct batch_state {
+    const fluxins::bytecode *program = nullptr;
+    const fluxins::code     *expr    = nullptr;
+    const fluxins::config   *cfg     = nullptr;
+
+    std::vector<const float *>                     columns;   ///< Column values for each name (if provided).
+    std::vector<std::optional<float>>              variables; ///< Context variable for each name (if resolved).
+    std::vector<const fluxins::fluxins_function *> functions; ///< Context function for each name (if resolved).
+
+    /// Vectorized function for each name (if resolved).
+    std::vector<std::optional<fluxins::vector_function>> vector_functions;
+
+    std::vector<float>         args;        ///< Reused storage for function arguments.
+    std::vector<const float *> column_args; ///< Reused storage for vectorized function arguments.
+    std::vector<float>         row_stack;   ///< Stack for executing rows one by one.
+};
+
+/// Apply unary operator to all values in-place.
+static void apply_unary(
+    const fluxins::unary_operator &op_info,
+    const fluxins::code           &expr,
+    fluxins::code_location         location,
+    float                         *x,
+    std::size_t                    count)
+{
+    using fluxins::intrinsic;
+
+    switch (op_info.builtin)
+    {
+        case intrinsic::add:
+            for (std::size_t i = 0; i < count; i++) x[i] = 0.0f + x[i];
+            return;
+        case intrinsic::subtract:
+            for (std::size_t i = 0; i < count; i++) x[i] = 0.0f - x[i];
+            return;
+        case intrinsic::multiply:
+            for (std::size_t i = 0; i < count; i++) x[i] = 1.0f * x[i];
+            return;
+        case intrinsic::divide:
+            // Let the operator report division by zero
+            if (std::find(x, x + count, 0.0f) != x + count) break;
+            for (std::size_t i = 0; i < count; i++) x[i] = 1.0f / x[i];
+            return;
+        case intrinsic::equal:
+            for (std::size_t i = 0; i < count; i++) x[i] = x[i] == 0.0f;
+            return;
+        default:
+            break;
+    }
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        x[i] = op_info.operate(expr, location, x[i]);
+    }
+}
+
+/// Apply binary operator to all values, result is stored in `x`.
+static void apply_binary(
+    const fluxins::binary_operator &op_info,
+    const fluxins::code            &expr,
+    fluxins::code_location          location,
+    float                          *x,
+    const float                    *y,
+    std::size_t                     count)
+{
+    using fluxins::intrinsic;
+
+    // clang-format off
+
+    switch (op_info.builtin)
+    {
+        case intrinsic::add:           for (std::size_t i = 0; i < count; i++) x[i] = x[i] + y[i]; return;
+        case intrinsic::subtract:      for (std::size_t i = 0; i < count; i++) x[i] = x[i] - y[i]; return;
+        case intrinsic::multiply:      for (std::size_t i = 0; i < count; i++) x[i] = x[i] * y[i]; return;
+        case intrinsic::power:         for (std::size_t i = 0; i < count; i++) x[i] = std::pow(x[i], y[i]); return;
+        case intrinsic::equal:         for (std::size_t i = 0; i < count; i++) x[i] = x[i] == y[i]; return;
+        case intrinsic::not_equal:     for (std::size_t i = 0; i < count; i++) x[i] = x[i] != y[i]; return;
+        case intrinsic::less:          for (std::size_t i = 0; i < count; i++) x[i] = x[i] < y[i]; return;
+        case intrinsic::greater:       for (std::size_t i = 0; i < count; i++) x[i] = x[i] > y[i]; return;
+        case intrinsic::less_equal:    for (std::size_t i = 0; i < count; i++) x[i] = x[i] <= y[i]; return;
+        case intrinsic::greater_equal: for (std::size_t i = 0; i < count; i++) x[i] = x[i] >= y[i]; return;
+        case intrinsic::logical_and:   for (std::size_t i = 0; i < count; i++) x[i] = x[i] != 0.0f && y[i] != 0.0f; return;
+        case intrinsic::logical_or:    for (std::size_t i = 0; i < count; i++) x[i] = x[i] != 0.0f || y[i] != 0.0f; return;
+        case intrinsic::minimum:       for (std::size_t i = 0; i < count; i++) x[i] = std::fmin(x[i], y[i]); return;
+        case intrinsic::maximum:       for (std::size_t i = 0; i < count; i++) x[i] = std::fmax(x[i], y[i]); return;
+        case intrinsic::divide:
+            // Let the operator report division by zero
+            if (std::find(y, y + count, 0.0f) != y + count) break;
+            for (std::size_t i = 0; i < count; i++) x[i] = x[i] / y[i];
+            return;
+        default:
+            break;
+    }
+
+    // clang-format on
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        x[i] = op_info.operate(expr, location, x[i], y[i]);
+    }
+}
+
+/// Execute the program for `count` rows starting at `begin`, from the
+/// instruction `pc` with `sp` slots on the stack.
+static void execute_block(
+    batch_state &state,
+    std::size_t  begin,
+    std::size_t  count,
+    float       *stack,
+    std::size_t  stride,
+    float       *output,
+    std::size_t  pc,
+    std::size_t  sp)
+{
+    const fluxins::bytecode &program = *state.program;
+    const fluxins::code     &expr    = *state.expr;
+
+    std::size_t size = program.instructions.size();
+
+    while (pc < size)
+    {
+        const fluxins::instruction   &inst     = program.instructions[pc];
+        const fluxins::code_location &location = program.locations[pc];
+
+        switch (inst.op)
+        {
+            case fluxins::opcode::push_number:
+                std::fill_n(stack + sp * stride, count, std::bit_cast<float>(inst.operand));
+                sp++;
+                break;
+
+            case fluxins::opcode::load_variable:
+                if (const float *values = state.columns[inst.operand])
+                {
+                    std::copy_n(values + begin, count, stack + sp * stride);
+                }
+                else if (auto variable = state.variables[inst.operand])
+                {
+                    std::fill_n(stack + sp * stride, count, *variable);
+                }
+                else
+                {
+                    float error = fluxins::report_error(fluxins::error_info::unresolved(program.names[inst.operand], "variable", location), expr);
+                    std::fill_n(stack + sp * stride, count, error);
+                }
+                sp++;
+                break;
+
+            case fluxins::opcode::call_function:
+            {
+                const fluxins::fluxins_function *function = state.functions[inst.operand];
+                sp -= inst.count;
+                float *first = stack + sp * stride;
+
+                if (!function || !*function)
+                {
+                    float error = fluxins::report_error(fluxins::error_info::unresolved(program.names[inst.operand], "function", location), expr);
+                    std::fill_n(first, count, error);
+                    sp++;
+                    break;
+                }
+
+                const auto &vector_function = state.vector_functions[inst.operand];
+                if (vector_function && vector_function->arity == inst.count)
+                {
+                    state.column_args.resize(inst.count);
+                    for (std::size_t arg = 0; arg < inst.count; arg++)
+                    {
+                        state.column_args[arg] = first + arg * stride;
+                    }
+                    vector_function->kernel(state.column_args, { first, count });
+                    sp++;
+                    break;
+                }
+
+                // Result of a row overwrites the first argument of the same row only
+                state.args.resize(inst.count);
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    for (std::size_t arg = 0; arg < inst.count; arg++)
+                    {
+                        state.args[arg] = first[arg * stride + i];
+                    }
+                    first[i] = (*function)(expr, location, state.args);
+                }
+                sp++;
+                break;
+            }
+
+            case fluxins::opcode::unary_prefix:
+                apply_unary(state.cfg->unary_prefix_operators[inst.operand], expr, location, stack + (sp - 1) * stride, count);
+                break;
+
+            case fluxins::opcode::unary_suffix:
+                apply_unary(state.cfg->unary_suffix_operators[inst.operand], expr, location, stack + (sp - 1) * stride, count);
+                break;
+
+            case fluxins::opcode::binary:
+                sp--;
+                apply_binary(state.cfg->binary_operators[inst.operand], expr, location, stack + (sp - 1) * stride, stack + sp * stride, count);
+                break;
+
+            case fluxins::opcode::jump:
+                pc = inst.operand;
+                continue;
+
+            case fluxins::opcode::jump_if_zero:
+            {
+                sp--;
+                const float *condition = stack + sp * stride;
+                std::size_t  zeros     = (std::size_t) std::count(condition, condition + count, 0.0f);
+
+                if (zeros == count)
+                {
+                    pc = inst.operand;
+                    continue;
+                }
+
+                if (zeros != 0)
+                {
+                    // Rows take different branches, continue executing them
+                    // one by one from their branch, so that the instructions
+                    // before the branch (and the functions they call) are not
+                    // executed again
+                    float *row_stack = state.row_stack.data();
+                    for (std::size_t i = 0; i < count; i++)
+                    {
+                        for (std::size_t slot = 0; slot < sp; slot++)
+                        {
+                            row_stack[slot] = stack[slot * stride + i];
+                        }
+                        for (std::size_t local = 0; local < program.locals; local++)
+                        {
+                            row_stack[program.max_stack + local] = stack[(program.max_stack + local) * stride + i];
+                        }
+
+                        std::size_t branch = condition[i] == 0.0f ? inst.operand : pc + 1;
+                        execute_block(state, begin + i, 1, row_stack, 1, output + i, branch, sp);
+                    }
+                    return;
+                }
+                break;
+            }
+
+            case fluxins::opcode::store_local:
+                std::copy_n(stack + (sp - 1) * stride, count, stack + (program.max_stack + inst.operand) * stride);
+                break;
+
+            case fluxins::opcode::load_local:
+                std::copy_n(stack + (program.max_stack + inst.operand) * stride, count, stack + sp * stride);
+                sp++;
+                break;
+
+            default:
+                // Possibly unreachable code
+                fluxins::report_error({ .message = "Invalid instruction", .location = location }, expr);
+                return;
+        }
+
+        pc++;
+    }
+
+    std::copy_n(stack, count, output);
+}
+
+void fluxins::execute_batch(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx,
+    std::span<const column>  columns,
+    std::span<float>         output)
+{
+    std::size_t rows = output.size();
+
+    for (const column &col : columns)
+    {
+        if (col.values.size() < rows)
+        {
+            FLUXINS_THROW(std::invalid_argument(std::format("Column '{}' has {} values, but {} rows are evaluated", col.name, col.values.size(), rows)));
+        }
+    }
+
+    // Operands of the operators are indices into the lists of operators of the
+    // config, which are only valid for the same version
+    if (program.version != cfg->version)
+    {
+        std::fill(output.begin(), output.end(), report_stale_program(expr));
+        return;
+    }
+
+    batch_state state = {
+        .program = &program,
+        .expr    = &expr,
+        .cfg     = cfg.get(),
+    };
+
+    // Resolve all the symbols once, missing symbols are reported only when the
+    // instructions referencing them are executed
+    state.columns.assign(program.names.size(), nullptr);
+    state.variables.assign(program.names.size(), std::nullopt);
+    state.functions.assign(program.names.size(), nullptr);
+    state.vector_functions.resize(program.names.size());
+
+    for (const instruction &inst : program.instructions)
+    {
+        if (inst.op == opcode::load_variable)
+        {
+            const std::string &name = program.names[inst.operand];
+
+            auto found = std::find_if(columns.begin(), columns.end(), [&](const column &col) { return col.name == name; });
+            if (found != columns.end())
+            {
+                state.columns[inst.operand] = found->values.data();
+            }
+            else if (!program.variables.empty() && program.variables[inst.operand])
+            {
+                state.variables[inst.operand] = *program.variables[inst.operand];
+            }
+            else
+            {
+                state.variables[inst.operand] = ctx ? ctx->resolve_variable(name) : std::nullopt;
+            }
+        }
+        else if (inst.op == opcode::call_function)
+        {
+            const fluxins_function *function = nullptr;
+            if (!program.functions.empty() && program.functions[inst.operand])
+            {
+                function = program.functions[inst.operand];
+            }
+            else if (ctx)
+            {
+                function = ctx->bind_function(program.names[inst.operand]);
+            }
+
+            state.functions[inst.operand] = function;
+            if (function && ctx)
+            {
+                state.vector_functions[inst.operand] = ctx->resolve_vector_function(program.names[inst.operand]);
+            }
+        }
+    }
+
+    // Locals are stored after the stack
+    state.row_stack.resize(program.max_stack + program.locals);
+
+    std::vector<float> stack((program.max_stack + program.locals) * batch_block_size);
+    for (std::size_t begin = 0; begin < rows; begin += batch_block_size)
+    {
+        std::size_t count = std::min(batch_block_size, rows - begin);
+        execute_block(state, begin, count, stack.data(), batch_block_size, output.data() + begin, 0, 0);
+    }
+}
@@ -0,0 +1,121 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for binding variables and
+/// functions referenced by AST and bytecode to the symbols in a context, and
+/// collecting the symbols referenced by AST.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/parser.hpp"
+
+void fluxins::number_ast::bind(std::shared_ptr<context> ctx)
+{
+}
+
+void fluxins::variable_ast::bind(std::shared_ptr<context> ctx)
+{
+    slot = ctx->bind_variable(name);
+}
+
+void fluxins::function_ast::bind(std::shared_ptr<context> ctx)
+{
+    target = ctx->bind_function(name);
+
+    for (auto &arg : args)
+    {
+        arg->bind(ctx);
+    }
+}
+
+void fluxins::operator_ast::bind(std::shared_ptr<context> ctx)
+{
+    if (left) left->bind(ctx);
+    if (right) right->bind(ctx);
+}
+
+void fluxins::conditional_ast::bind(std::shared_ptr<context> ctx)
+{
+    condition->bind(ctx);
+    true_value->bind(ctx);
+    false_value->bind(ctx);
+}
+
+void fluxins::shared_ast::bind(std::shared_ptr<context> ctx)
+{
+    node->bind(ctx);
+}
+
+void fluxins::bind(bytecode &program, std::shared_ptr<context> ctx)
+{
+    program.variables.assign(program.names.size(), nullptr);
+    program.functions.assign(program.names.size(), nullptr);
+
+    for (const instruction &inst : program.instructions)
+    {
+        if (inst.op == opcode::load_variable)
+        {
+            program.variables[inst.operand] = ctx->bind_variable(program.names[inst.operand]);
+        }
+        else if (inst.op == opcode::call_function)
+        {
+            program.functions[inst.operand] = ctx->bind_function(program.names[inst.operand]);
+        }
+    }
+}
+
+/// Add the name to the names if it is not in the names yet.
+static void add_symbol(std::vector<std::string> &names, const std::string &name)
+{
+    if (std::find(names.begin(), names.end(), name) == names.end())
+    {
+        names.emplace_back(name);
+    }
+}
+
+void fluxins::number_ast::collect_symbols(ast_symbols &symbols) const
+{
+}
+
+void fluxins::variable_ast::collect_symbols(ast_symbols &symbols) const
+{
+    add_symbol(symbols.variables, name);
+}
+
+void fluxins::function_ast::collect_symbols(ast_symbols &symbols) const
+{
+    add_symbol(symbols.functions, name);
+
+    for (const auto &arg : args)
+    {
+        arg->collect_symbols(symbols);
+    }
+}
+
+void fluxins::operator_ast::collect_symbols(ast_symbols &symbols) const
+{
+    if (left) left->collect_symbols(symbols);
+    if (right) right->collect_symbols(symbols);
+}
+
+void fluxins::conditional_ast::collect_symbols(ast_symbols &symbols) const
+{
+    condition->collect_symbols(symbols);
+    true_value->collect_symbols(symbols);
+    false_value->collect_symbols(symbols);
+}
+
+void fluxins::shared_ast::collect_symbols(ast_symbols &symbols) const
+{
+    node->collect_symbols(symbols);
+}
@@ -15,10 +15,12 @@
 #include <ctime>
 #include <numbers>
 #include <numeric>
+#include <span>
 
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
 #include "fluxins/error.hpp"
+#include "fluxins/vector_math.hpp"
 
 #define ARITY_ZERO_OR_MORE (std::size_t) -1
 #define ARITY_ONE_OR_MORE (std::size_t) -2
@@ -30,25 +32,48 @@
     }                                  \
     while (false)
 
-#define REGISTER_FUNCTION(name, arity, ...)                                                                     \
+#define REGISTER_FUNCTION_WITH_PURITY(name, arity, pure, ...)                                                   \
     do                                                                                                          \
     {                                                                                                           \
         set_function(name, [](FLUXINS_FN_PARAMS) -> float {                                                     \
             if ((arity) == ARITY_ONE_OR_MORE)                                                                   \
             {                                                                                                   \
-                if (params.size() == 0) throw fluxins::invalid_arity((name), params.size(), 1, expr, location); \
+                if (params.size() == 0) return fluxins::report_error(fluxins::error_info::arity_mismatch((name), params.size(), 1, location), expr); \
             }                                                                                                   \
             else if ((arity) != ARITY_ZERO_OR_MORE)                                                             \
             {                                                                                                   \
                 FLUXINS_FN_ARITY((name), (arity));                                                              \
             }                                                                                                   \
             __VA_ARGS__                                                                                         \
-        });                                                                                                     \
+        }, builtin_traits((arity), (pure)));                                                                    \
     }                                                                                                           \
     while (false)
 
+#define REGISTER_FUNCTION(name, arity, ...) REGISTER_FUNCTION_WITH_PURITY(name, arity, true, __VA_ARGS__)
+#define REGISTER_IMPURE_FUNCTION(name, arity, ...) REGISTER_FUNCTION_WITH_PURITY(name, arity, false, __VA_ARGS__)
+
+#define REGISTER_VECTOR_FUNCTION(name, arity, ...)                                                           \
+    do                                                                                                       \
+    {                                                                                                        \
+        set_vector_function(name, arity, [](std::span<const float *const> params, std::span<float> output) { \
+            std::size_t count = output.size();                                                               \
+            __VA_ARGS__                                                                                      \
+        });                                                                                                  \
+    }                                                                                                        \
+    while (false)
+
 // Utilities
 
+static fluxins::function_traits builtin_traits(std::size_t arity, bool pure)
+{
+    switch (arity)
+    {
+        case ARITY_ZERO_OR_MORE: return { pure, 0, (std::size_t) -1 };
+        case ARITY_ONE_OR_MORE: return { pure, 1, (std::size_t) -1 };
+        default: return { pure, arity, arity };
+    }
+}
+
 static float factorial(float x)
 {
     if (x < 0.0f)
@@ -141,8 +166,9 @@ void fluxins::context::populate()
     REGISTER_FUNCTION("exp2",           1, return std::exp2(params[0]););
     REGISTER_FUNCTION("expint",         1, return std::expint(params[0]););
     REGISTER_FUNCTION("expm1",          1, return std::expm1(params[0]););
-    REGISTER_FUNCTION("fegetround",     2, return (float)std::fegetround(););
-    REGISTER_FUNCTION("fesetround",     1, return (float)std::fesetround(params[0]););
+    // Rounding mode is a global state
+    REGISTER_IMPURE_FUNCTION("fegetround", 2, return (float)std::fegetround(););
+    REGISTER_IMPURE_FUNCTION("fesetround", 1, return (float)std::fesetround(params[0]););
     REGISTER_FUNCTION("fma",            3, return std::fma(params[0], params[1], params[2]););
     REGISTER_FUNCTION("floor",          1, return std::floor(params[0]););
     REGISTER_FUNCTION("gcd",            2, return (float)std::gcd((int)std::round(params[0]), (int)std::round(params[1])););
@@ -182,9 +208,31 @@ void fluxins::context::populate()
 
     // A few custom functions
     REGISTER_FUNCTION("avg",            ARITY_ONE_OR_MORE, return std::accumulate(params.begin(), params.end(), 0.0f) / params.size(););
-    REGISTER_FUNCTION("rand",           0, return (float)std::rand() / (float)RAND_MAX;);
-    REGISTER_FUNCTION("srand",          1, std::srand((unsigned int)params[0]); return 0.0f;);
-    REGISTER_FUNCTION("time",           0, return (float)std::time(nullptr););
+    REGISTER_IMPURE_FUNCTION("rand",     0, return (float)std::rand() / (float)RAND_MAX;);
+    REGISTER_IMPURE_FUNCTION("srand",    1, std::srand((unsigned int)params[0]); return 0.0f;);
+    REGISTER_IMPURE_FUNCTION("time",     0, return (float)std::time(nullptr););
+
+    // Vectorized implementations used by batched evaluation, see
+    // `vector_math.hpp`. Only kernels faster than the scalar functions are
+    // registered
+    REGISTER_VECTOR_FUNCTION("cos",     1, fluxins::simd::cos({ params[0], count }, output););
+    REGISTER_VECTOR_FUNCTION("log10",   1, fluxins::simd::log10({ params[0], count }, output););
+    REGISTER_VECTOR_FUNCTION("sin",     1, fluxins::simd::sin({ params[0], count }, output););
+    REGISTER_VECTOR_FUNCTION("sqrt",    1, fluxins::simd::sqrt({ params[0], count }, output););
+    REGISTER_VECTOR_FUNCTION("tan",     1, fluxins::simd::tan({ params[0], count }, output););
+    REGISTER_VECTOR_FUNCTION("tanh",    1, fluxins::simd::tanh({ params[0], count }, output););
+
+    if (fluxins::simd::wide_vectors())
+    {
+        REGISTER_VECTOR_FUNCTION("ceil",    1, fluxins::simd::ceil({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("exp",     1, fluxins::simd::exp({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("exp2",    1, fluxins::simd::exp2({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("floor",   1, fluxins::simd::floor({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("log",     1, fluxins::simd::log({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("log2",    1, fluxins::simd::log2({ params[0], count }, output););
+        REGISTER_VECTOR_FUNCTION("pow",     2, fluxins::simd::pow({ params[0], count }, { params[1], count }, output););
+        REGISTER_VECTOR_FUNCTION("trunc",   1, fluxins::simd::trunc({ params[0], count }, output););
+    }
 
     // clang-format on
 }
@@ -196,11 +244,11 @@ fluxins::config::config()
     // NOTE: BE SURE TO MODIFY TEST FILES AND readme.md FILE WHEN ADDING
     // NEW OPERATORS OR MODIFYING EXISTING ONES.
     unary_prefix_operators = {
-        unary_operator{ "+", [](FLUXINS_UOP_PARAMS) -> float { return 0.0f + x; } },
-        unary_operator{ "-", [](FLUXINS_UOP_PARAMS) -> float { return 0.0f - x; } },
-        unary_operator{ "*", [](FLUXINS_UOP_PARAMS) -> float { return 1.0f * x; } },
-        unary_operator{ "/", [](FLUXINS_UOP_PARAMS) -> float { if (x == 0.0f) throw code_error("Division by zero", expr, location); return 1.0f / x; } },
-        unary_operator{ "!", [](FLUXINS_UOP_PARAMS) -> float { return x == 0.0f; } },
+        unary_operator{ "+", [](FLUXINS_UOP_PARAMS) -> float { return 0.0f + x; }, intrinsic::add },
+        unary_operator{ "-", [](FLUXINS_UOP_PARAMS) -> float { return 0.0f - x; }, intrinsic::subtract },
+        unary_operator{ "*", [](FLUXINS_UOP_PARAMS) -> float { return 1.0f * x; }, intrinsic::multiply },
+        unary_operator{ "/", [](FLUXINS_UOP_PARAMS) -> float { if (x == 0.0f) return report_error({ .message = "Division by zero", .location = location }, expr); return 1.0f / x; }, intrinsic::divide },
+        unary_operator{ "!", [](FLUXINS_UOP_PARAMS) -> float { return x == 0.0f; }, intrinsic::equal },
         unary_operator{ "~", [](FLUXINS_UOP_PARAMS) -> float { return ~(int)(x); } },
     };
 
@@ -209,22 +257,22 @@ fluxins::config::config()
     };
 
     binary_operators = {
-        { "+",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x + y; } },
-        { "-",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x - y; } },
-        { "*",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x * y; } },
-        { "/",  associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) throw code_error("Division by zero", expr, location); return x / y; } },
-        { "%",  associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) throw code_error("Modulo by zero", expr, location); return std::fmod(x, y); } },
-        { "%%", associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) throw code_error("Wrapping modulo by zero", expr, location); return wrapping_modulo(x, y); } },
-        { "**", associativity::right, [](FLUXINS_BOP_PARAMS) { return std::pow(x, y); } },
-        { "//", associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) throw code_error("Flooring division by zero", expr, location); return std::floor(x / y); } },
-        { "==", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x == y; } },
-        { "!=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x != y; } },
-        { "<",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x < y; } },
-        { ">",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x > y; } },
-        { "<=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x <= y; } },
-        { ">=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x >= y; } },
-        { "&&", associativity::left,  [](FLUXINS_BOP_PARAMS) { return (x != 0.0f && y != 0.0f); } },
-        { "||", associativity::left,  [](FLUXINS_BOP_PARAMS) { return (x != 0.0f || y != 0.0f); } },
+        { "+",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x + y; }, intrinsic::add },
+        { "-",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x - y; }, intrinsic::subtract },
+        { "*",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x * y; }, intrinsic::multiply },
+        { "/",  associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) return report_error({ .message = "Division by zero", .location = location }, expr); return x / y; }, intrinsic::divide },
+        { "%",  associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) return report_error({ .message = "Modulo by zero", .location = location }, expr); return std::fmod(x, y); } },
+        { "%%", associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) return report_error({ .message = "Wrapping modulo by zero", .location = location }, expr); return wrapping_modulo(x, y); } },
+        { "**", associativity::right, [](FLUXINS_BOP_PARAMS) { return std::pow(x, y); }, intrinsic::power },
+        { "//", associativity::left,  [](FLUXINS_BOP_PARAMS) { if (y == 0.0f) return report_error({ .message = "Flooring division by zero", .location = location }, expr); return std::floor(x / y); } },
+        { "==", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x == y; }, intrinsic::equal },
+        { "!=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x != y; }, intrinsic::not_equal },
+        { "<",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x < y; }, intrinsic::less },
+        { ">",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return x > y; }, intrinsic::greater },
+        { "<=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x <= y; }, intrinsic::less_equal },
+        { ">=", associativity::left,  [](FLUXINS_BOP_PARAMS) { return x >= y; }, intrinsic::greater_equal },
+        { "&&", associativity::left,  [](FLUXINS_BOP_PARAMS) { return (x != 0.0f && y != 0.0f); }, intrinsic::logical_and },
+        { "||", associativity::left,  [](FLUXINS_BOP_PARAMS) { return (x != 0.0f || y != 0.0f); }, intrinsic::logical_or },
         { "&",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return (float)((int) x & (int) y); } },
         { "|",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return (float)((int) x | (int) y); } },
         { "^",  associativity::left,  [](FLUXINS_BOP_PARAMS) { return (float)((int) x ^ (int) y); } },
@@ -232,10 +280,12 @@ fluxins::config::config()
         { ">>", associativity::left,  [](FLUXINS_BOP_PARAMS) { return (float)((int) x >> (int) y); } },
         { "!!", associativity::left,  [](FLUXINS_BOP_PARAMS) { return std::fabs(x - y); } },
         { "??", associativity::right, [](FLUXINS_BOP_PARAMS) { return x != 0.0f ? x : y; } },
-        { "<?", associativity::left,  [](FLUXINS_BOP_PARAMS) { return std::fmin(x, y); } },
-        { ">?", associativity::left,  [](FLUXINS_BOP_PARAMS) { return std::fmax(x, y); } },
+        { "<?", associativity::left,  [](FLUXINS_BOP_PARAMS) { return std::fmin(x, y); }, intrinsic::minimum },
+        { ">?", associativity::left,  [](FLUXINS_BOP_PARAMS) { return std::fmax(x, y); }, intrinsic::maximum },
     };
 
+    update_lookup();
+
     // Precedence in order of highest to lowest
 
     assign_precedence("<<", true);
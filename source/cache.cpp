@@ -0,0 +1,175 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for the cache of parsed
+/// expressions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "fluxins/cache.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/parser.hpp"
+
+/// Mix the value into the hash.
+static std::size_t hash_combine(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2));
+}
+
+std::size_t fluxins::expression_cache::key_hash::operator()(const key &k) const
+{
+    std::size_t seed = std::hash<std::string_view> {}(k.expr);
+    seed             = hash_combine(seed, std::hash<const config *> {}(k.cfg));
+    return hash_combine(seed, k.version);
+}
+
+fluxins::expression_cache::expression_cache(std::size_t capacity) : capacity(capacity)
+{
+}
+
+std::shared_ptr<const fluxins::parsed_expression> fluxins::expression_cache::parse(const code &expr, std::shared_ptr<config> cfg)
+{
+    if (auto cached = find(expr.expr, cfg))
+    {
+        return cached;
+    }
+
+    // Results of the stages after a collected error are not valid
+    const error_sink *sink = error_sink::active();
+
+    auto parsed    = std::make_shared<parsed_expression>();
+    parsed->tokens = tokenize_packed(expr);
+    if (sink && sink->error)
+    {
+        return nullptr;
+    }
+
+    parsed->ast = ::fluxins::parse(expr, parsed->tokens, cfg);
+    if (!parsed->ast || (sink && sink->error))
+    {
+        return nullptr;
+    }
+
+    insert(expr.expr, cfg, parsed);
+    return parsed;
+}
+
+std::shared_ptr<const fluxins::parsed_expression> fluxins::expression_cache::find(std::string_view expr, const std::shared_ptr<config> &cfg)
+{
+    std::lock_guard lock(mutex);
+
+    auto it = positions.find({ expr, cfg.get(), cfg->version });
+
+    // Config at the same address may be a new config after the old one was
+    // destroyed
+    if (it == positions.end() || it->second->owner.expired())
+    {
+        misses++;
+        return nullptr;
+    }
+
+    // Move to the front, as the most recently used
+    entries.splice(entries.begin(), entries, it->second);
+
+    hits++;
+    return it->second->parsed;
+}
+
+void fluxins::expression_cache::insert(std::string_view expr, const std::shared_ptr<config> &cfg, std::shared_ptr<const parsed_expression> parsed)
+{
+    std::lock_guard lock(mutex);
+
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    auto it = positions.find({ expr, cfg.get(), cfg->version });
+    if (it != positions.end())
+    {
+        it->second->owner  = cfg;
+        it->second->parsed = std::move(parsed);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.emplace_front(entry {
+        .expr    = std::string(expr),
+        .cfg     = cfg.get(),
+        .version = cfg->version,
+        .owner   = cfg,
+        .parsed  = std::move(parsed),
+    });
+
+    const entry &added = entries.front();
+    positions.emplace(key { added.expr, added.cfg, added.version }, entries.begin());
+
+    evict();
+}
+
+void fluxins::expression_cache::clear()
+{
+    std::lock_guard lock(mutex);
+
+    positions.clear();
+    entries.clear();
+}
+
+void fluxins::expression_cache::set_capacity(std::size_t capacity)
+{
+    std::lock_guard lock(mutex);
+
+    this->capacity = capacity;
+    evict();
+}
+
+fluxins::cache_statistics fluxins::expression_cache::statistics() const
+{
+    std::lock_guard lock(mutex);
+
+    return {
+        .hits      = hits,
+        .misses    = misses,
+        .evictions = evictions,
+        .size      = entries.size(),
+        .capacity  = capacity,
+    };
+}
+
+void fluxins::expression_cache::reset_statistics()
+{
+    std::lock_guard lock(mutex);
+
+    hits      = 0;
+    misses    = 0;
+    evictions = 0;
+}
+
+void fluxins::expression_cache::evict()
+{
+    while (entries.size() > capacity)
+    {
+        const entry &last = entries.back();
+        positions.erase({ last.expr, last.cfg, last.version });
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+fluxins::expression_cache &fluxins::global_cache()
+{
+    static expression_cache cache;
+    return cache;
+}
@@ -0,0 +1,281 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for compacting AST into one
+/// contiguous arena and evaluating the compact AST.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/compact_ast.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/parser.hpp"
+
+/// Evaluate the node of the compact AST.
+static float evaluate_node(
+    const fluxins::compact_ast      &tree,
+    std::uint32_t                    index,
+    const fluxins::evaluation_frame &frame)
+{
+    using fluxins::compact_kind;
+
+    const fluxins::compact_node &node     = tree.nodes[index];
+    const std::uint32_t         *children = tree.children.data() + node.first;
+
+    switch (node.kind)
+    {
+        case compact_kind::number:
+            return std::bit_cast<float>(node.value);
+
+        case compact_kind::variable:
+        {
+            const std::string &name = tree.names[node.value];
+            if (frame.ctx)
+            {
+                if (auto resolved = frame.ctx->resolve_variable(name))
+                {
+                    return *resolved;
+                }
+            }
+
+            return fluxins::report_error(fluxins::error_info::unresolved(name, "variable", tree.locations[index]), frame.expr);
+        }
+
+        case compact_kind::function:
+        {
+            const std::string &name = tree.names[node.value];
+
+            const fluxins::fluxins_function *function = frame.ctx ? frame.ctx->bind_function(name) : nullptr;
+            if (!function || !*function)
+            {
+                return fluxins::report_error(fluxins::error_info::unresolved(name, "function", tree.locations[index]), frame.expr);
+            }
+
+            std::vector<float> evaluated_args(node.count);
+            for (std::size_t i = 0; i < node.count; i++)
+            {
+                evaluated_args[i] = evaluate_node(tree, children[i], frame);
+            }
+
+            return (*function)(frame.expr, tree.locations[index], evaluated_args);
+        }
+
+        case compact_kind::unary_prefix:
+        {
+            const auto &op_info = frame.cfg.unary_prefix_operators[node.value];
+            return op_info.operate(frame.expr, tree.locations[index], evaluate_node(tree, children[0], frame));
+        }
+
+        case compact_kind::unary_suffix:
+        {
+            const auto &op_info = frame.cfg.unary_suffix_operators[node.value];
+            return op_info.operate(frame.expr, tree.locations[index], evaluate_node(tree, children[0], frame));
+        }
+
+        case compact_kind::binary:
+        {
+            const auto &op_info = frame.cfg.binary_operators[node.value];
+            float       left    = evaluate_node(tree, children[0], frame);
+            float       right   = evaluate_node(tree, children[1], frame);
+            return op_info.operate(frame.expr, tree.locations[index], left, right);
+        }
+
+        case compact_kind::conditional:
+            if (evaluate_node(tree, children[0], frame) != 0.0f)
+            {
+                return evaluate_node(tree, children[1], frame);
+            }
+            return evaluate_node(tree, children[2], frame);
+
+        default:
+            // Possibly unreachable code
+            return fluxins::report_error({ .message = "Invalid node", .location = tree.locations[index] }, frame.expr);
+    }
+}
+
+std::uint32_t fluxins::compact_ast::add_node(
+    compact_kind                   kind,
+    std::uint32_t                  value,
+    std::span<const std::uint32_t> node_children,
+    code_location                  location)
+{
+    compact_node node = {
+        .kind  = kind,
+        .count = (std::uint16_t) node_children.size(),
+        .value = value,
+        .first = (std::uint32_t) children.size(),
+    };
+
+    children.insert(children.end(), node_children.begin(), node_children.end());
+    nodes.emplace_back(node);
+    locations.emplace_back(location);
+    return (std::uint32_t) nodes.size() - 1;
+}
+
+std::uint32_t fluxins::compact_ast::add_name(std::string_view name)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end())
+    {
+        return (std::uint32_t) std::distance(names.begin(), it);
+    }
+
+    names.emplace_back(name);
+    return (std::uint32_t) names.size() - 1;
+}
+
+std::uint32_t fluxins::number_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    return tree.add_node(compact_kind::number, std::bit_cast<std::uint32_t>(value), {}, location);
+}
+
+std::uint32_t fluxins::variable_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    return tree.add_node(compact_kind::variable, tree.add_name(name), {}, location);
+}
+
+std::uint32_t fluxins::function_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    if (args.size() > std::numeric_limits<std::uint16_t>::max())
+    {
+        FLUXINS_THROW(code_error("Too many arguments for function", expr, location));
+    }
+
+    std::vector<std::uint32_t> compacted_args(args.size());
+    for (std::size_t i = 0; i < args.size(); i++)
+    {
+        compacted_args[i] = args[i]->compact(expr, cfg, tree);
+    }
+
+    return tree.add_node(compact_kind::function, tree.add_name(name), compacted_args, location);
+}
+
+std::uint32_t fluxins::operator_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    std::size_t op_index = find(*cfg);
+
+    if (left && right)
+    {
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            FLUXINS_THROW(unresolved_reference(symbol, "binary operator", expr, location));
+        }
+
+        std::array<std::uint32_t, 2> operands = {
+            left->compact(expr, cfg, tree),
+            right->compact(expr, cfg, tree),
+        };
+        return tree.add_node(compact_kind::binary, (std::uint32_t) op_index, operands, location);
+    }
+    else if (left)
+    {
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            FLUXINS_THROW(unresolved_reference(symbol, "unary suffix operator", expr, location));
+        }
+
+        std::uint32_t operand = left->compact(expr, cfg, tree);
+        return tree.add_node(compact_kind::unary_suffix, (std::uint32_t) op_index, { &operand, 1 }, location);
+    }
+    else if (right)
+    {
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            FLUXINS_THROW(unresolved_reference(symbol, "unary prefix operator", expr, location));
+        }
+
+        std::uint32_t operand = right->compact(expr, cfg, tree);
+        return tree.add_node(compact_kind::unary_prefix, (std::uint32_t) op_index, { &operand, 1 }, location);
+    }
+
+    // Possibly unreachable code
+    FLUXINS_THROW(code_error("No operands for operator was specified", expr, location));
+}
+
+std::uint32_t fluxins::conditional_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    std::array<std::uint32_t, 3> operands = {
+        condition->compact(expr, cfg, tree),
+        true_value->compact(expr, cfg, tree),
+        false_value->compact(expr, cfg, tree),
+    };
+    return tree.add_node(compact_kind::conditional, 0, operands, location);
+}
+
+std::uint32_t fluxins::shared_ast::compact(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    compact_ast            &tree) const
+{
+    if (slot < tree.shared_nodes.size() && tree.shared_nodes[slot] != (std::uint32_t) -1)
+    {
+        return tree.shared_nodes[slot];
+    }
+
+    std::uint32_t index = node->compact(expr, cfg, tree);
+
+    if (slot >= tree.shared_nodes.size())
+    {
+        tree.shared_nodes.resize(slot + 1, (std::uint32_t) -1);
+    }
+    tree.shared_nodes[slot] = index;
+    return index;
+}
+
+fluxins::compact_ast fluxins::compact(
+    const code               &expr,
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<config>   cfg)
+{
+    compact_ast tree;
+    ast->compact(expr, cfg, tree);
+
+    // Compacting state is not needed anymore
+    tree.shared_nodes = {};
+
+    tree.nodes.shrink_to_fit();
+    tree.children.shrink_to_fit();
+    tree.names.shrink_to_fit();
+    tree.locations.shrink_to_fit();
+    return tree;
+}
+
+float fluxins::evaluate(const compact_ast &tree, const evaluation_frame &frame)
+{
+    return evaluate_node(tree, tree.root(), frame);
+}
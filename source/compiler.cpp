@@ -0,0 +1,213 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for compiling AST into bytecode.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/parser.hpp"
+
+std::size_t fluxins::bytecode::emit(const instruction &inst, code_location location)
+{
+    switch (inst.op)
+    {
+        case opcode::push_number:
+        case opcode::load_variable:
+            depth++;
+            break;
+        case opcode::load_local:
+            depth++;
+            locals = std::max(locals, (std::size_t) inst.operand + 1);
+            break;
+        case opcode::store_local:
+            locals = std::max(locals, (std::size_t) inst.operand + 1);
+            break;
+        case opcode::call_function:
+            depth = depth - inst.count + 1;
+            break;
+        case opcode::binary:
+        case opcode::jump_if_zero:
+            depth--;
+            break;
+        default:
+            break;
+    }
+
+    max_stack = std::max(max_stack, depth);
+
+    instructions.emplace_back(inst);
+    locations.emplace_back(location);
+    return instructions.size() - 1;
+}
+
+std::uint32_t fluxins::bytecode::add_name(std::string_view name)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end())
+    {
+        return (std::uint32_t) std::distance(names.begin(), it);
+    }
+
+    names.emplace_back(name);
+    return (std::uint32_t) names.size() - 1;
+}
+
+void fluxins::number_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    program.emit({ opcode::push_number, std::bit_cast<std::uint32_t>(value) }, location);
+}
+
+void fluxins::variable_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    program.emit({ opcode::load_variable, program.add_name(name) }, location);
+}
+
+void fluxins::function_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    for (const auto &arg : args)
+    {
+        arg->compile(expr, cfg, program);
+    }
+
+    program.emit({ opcode::call_function, program.add_name(name), (std::uint32_t) args.size() }, location);
+}
+
+void fluxins::operator_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    if (left)
+    {
+        left->compile(expr, cfg, program);
+    }
+    if (right)
+    {
+        right->compile(expr, cfg, program);
+    }
+
+    if (left && right)
+    {
+        std::size_t op_index = find(*cfg);
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            report_error(error_info::unresolved(symbol, "binary operator", location), expr);
+            return;
+        }
+
+        program.emit({ opcode::binary, (std::uint32_t) op_index }, location);
+    }
+    else if (left)
+    {
+        std::size_t op_index = find(*cfg);
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            report_error(error_info::unresolved(symbol, "unary suffix operator", location), expr);
+            return;
+        }
+
+        program.emit({ opcode::unary_suffix, (std::uint32_t) op_index }, location);
+    }
+    else if (right)
+    {
+        std::size_t op_index = find(*cfg);
+        if (op_index == (std::size_t) -1)
+        {
+            // Can happen if the configuration is modified after the expression is parsed
+            report_error(error_info::unresolved(symbol, "unary prefix operator", location), expr);
+            return;
+        }
+
+        program.emit({ opcode::unary_prefix, (std::uint32_t) op_index }, location);
+    }
+    else
+    {
+        // Possibly unreachable code
+        report_error({ .message = "No operands for operator was specified", .location = location }, expr);
+    }
+}
+
+void fluxins::conditional_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    condition->compile(expr, cfg, program);
+    std::size_t jump_to_false = program.emit({ opcode::jump_if_zero }, location);
+
+    // Locals computed in only one of the branches are not computed after it
+    std::vector<bool> computed_locals = program.computed_locals;
+
+    true_value->compile(expr, cfg, program);
+    std::size_t jump_to_end = program.emit({ opcode::jump }, location);
+
+    // Only one of the branches is executed, the false branch starts with the
+    // same stack depth as the true branch
+    program.depth--;
+    program.computed_locals = computed_locals;
+
+    program.instructions[jump_to_false].operand = (std::uint32_t) program.instructions.size();
+    false_value->compile(expr, cfg, program);
+    program.instructions[jump_to_end].operand = (std::uint32_t) program.instructions.size();
+
+    program.computed_locals = computed_locals;
+}
+
+void fluxins::shared_ast::compile(
+    const code             &expr,
+    std::shared_ptr<config> cfg,
+    bytecode               &program) const
+{
+    if (slot < program.computed_locals.size() && program.computed_locals[slot])
+    {
+        program.emit({ opcode::load_local, slot }, location);
+        return;
+    }
+
+    node->compile(expr, cfg, program);
+    program.emit({ opcode::store_local, slot }, location);
+
+    if (slot >= program.computed_locals.size())
+    {
+        program.computed_locals.resize(slot + 1);
+    }
+    program.computed_locals[slot] = true;
+}
+
+fluxins::bytecode fluxins::compile(
+    const code               &expr,
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<config>   cfg)
+{
+    bytecode program;
+    program.version = cfg->version;
+    ast->compile(expr, cfg, program);
+    return program;
+}
@@ -7,13 +7,18 @@
 ///
 /// This project is licensed under the terms of MIT License.
 
+#include <bit>
+#include <cstddef>
 #include <format>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "fluxins/bytecode.hpp"
 #include "fluxins/code.hpp"
+#include "fluxins/compact_ast.hpp"
 #include "fluxins/config.hpp"
+#include "fluxins/error.hpp"
 #include "fluxins/parser.hpp"
 
 std::string repeat_string(std::string_view str, int count)
@@ -36,6 +41,20 @@ std::string fluxins::associativity_to_string(associativity assoc)
     }
 }
 
+std::string fluxins::error_kind_to_string(error_kind kind)
+{
+    switch (kind)
+    {
+        case error_kind::code_error:           return "code_error";
+        case error_kind::invalid_arity:        return "invalid_arity";
+        case error_kind::tokenizer_error:      return "tokenizer_error";
+        case error_kind::unexpected_token:     return "unexpected_token";
+        case error_kind::unresolved_reference: return "unresolved_reference";
+        case error_kind::exception:            return "exception";
+        default:                               return "unknown";
+    }
+}
+
 std::string fluxins::token_type_to_string(token::token_type type)
 {
     switch (type)
@@ -76,6 +95,29 @@ std::string fluxins::tokens_to_string(const code &expr, const std::vector<token>
     return str;
 }
 
+std::string fluxins::token_to_string(const code &expr, const packed_token &tok)
+{
+    std::string str = std::format(
+        "Token: Type: {}, Value: {}, Location: {}:{}\n{}",
+        token_type_to_string(tok.type),
+        tok.value(expr),
+        tok.begin,
+        tok.length,
+        tok.location().preview_text(expr));
+
+    return str;
+}
+
+std::string fluxins::tokens_to_string(const code &expr, const std::vector<packed_token> &tokens)
+{
+    std::string str;
+    for (const auto &tok : tokens)
+    {
+        str += token_to_string(expr, tok);
+    }
+    return str;
+}
+
 std::string fluxins::number_ast::to_string(const code &expr, int indent) const
 {
     std::string padding = repeat_string("  ", indent);
@@ -144,3 +186,105 @@ std::string fluxins::conditional_ast::to_string(const code &expr, int indent) co
     str += false_value->to_string(expr, indent + 1);
     return str;
 }
+
+std::string fluxins::shared_ast::to_string(const code &expr, int indent) const
+{
+    std::string padding = repeat_string("  ", indent);
+    std::string str     = padding;
+    str += std::format("Shared: Slot: {}, Location: {}:{}\n{}", slot, location.begin, location.length, location.preview_text(expr, indent * 2));
+    str += padding;
+    str += "Node:\n";
+    str += node->to_string(expr, indent + 1);
+    return str;
+}
+
+std::string fluxins::opcode_to_string(opcode op)
+{
+    switch (op)
+    {
+        case opcode::push_number:   return "push_number";
+        case opcode::load_variable: return "load_variable";
+        case opcode::call_function: return "call_function";
+        case opcode::unary_prefix:  return "unary_prefix";
+        case opcode::unary_suffix:  return "unary_suffix";
+        case opcode::binary:        return "binary";
+        case opcode::jump:          return "jump";
+        case opcode::jump_if_zero:  return "jump_if_zero";
+        case opcode::store_local:   return "store_local";
+        case opcode::load_local:    return "load_local";
+        default:                    return "unknown";
+    }
+}
+
+std::string fluxins::bytecode_to_string(const code &expr, const bytecode &program)
+{
+    std::string str = std::format("Bytecode: Instructions: {}, Max stack: {}\n", program.instructions.size(), program.max_stack);
+    for (std::size_t i = 0; i < program.instructions.size(); i++)
+    {
+        const instruction &inst = program.instructions[i];
+        str += std::format("{:4} {:14}", i, opcode_to_string(inst.op));
+        switch (inst.op)
+        {
+            case opcode::push_number:
+                str += std::format(" {}", std::bit_cast<float>(inst.operand));
+                break;
+            case opcode::load_variable:
+                str += std::format(" {}", program.names[inst.operand]);
+                break;
+            case opcode::call_function:
+                str += std::format(" {}, {} args", program.names[inst.operand], inst.count);
+                break;
+            default:
+                str += std::format(" {}", inst.operand);
+                break;
+        }
+        str += "\n";
+    }
+    return str;
+}
+
+std::string fluxins::compact_kind_to_string(compact_kind kind)
+{
+    switch (kind)
+    {
+        case compact_kind::number:       return "number";
+        case compact_kind::variable:     return "variable";
+        case compact_kind::function:     return "function";
+        case compact_kind::unary_prefix: return "unary_prefix";
+        case compact_kind::unary_suffix: return "unary_suffix";
+        case compact_kind::binary:       return "binary";
+        case compact_kind::conditional:  return "conditional";
+        default:                         return "unknown";
+    }
+}
+
+std::string fluxins::compact_ast_to_string(const code &expr, const compact_ast &tree)
+{
+    std::string str = std::format("Compact AST: Nodes: {}, Root: {}\n", tree.nodes.size(), tree.root());
+    for (std::size_t i = 0; i < tree.nodes.size(); i++)
+    {
+        const compact_node &node = tree.nodes[i];
+        str += std::format("{:4} {:12}", i, compact_kind_to_string(node.kind));
+        switch (node.kind)
+        {
+            case compact_kind::number:
+                str += std::format(" {}", std::bit_cast<float>(node.value));
+                break;
+            case compact_kind::variable:
+            case compact_kind::function:
+                str += std::format(" {}", tree.names[node.value]);
+                break;
+            case compact_kind::conditional:
+                break;
+            default:
+                str += std::format(" {}", node.value);
+                break;
+        }
+        for (std::size_t child = 0; child < node.count; child++)
+        {
+            str += std::format("{} {}", child == 0 ? " <-" : ",", tree.children[node.first + child]);
+        }
+        str += "\n";
+    }
+    return str;
+}
@@ -17,116 +17,166 @@
 #include "fluxins/error.hpp"
 #include "fluxins/parser.hpp"
 
-float fluxins::number_ast::evaluate(
+float fluxins::ast_node::evaluate(
     const code              &expr,
     std::shared_ptr<config>  cfg,
     std::shared_ptr<context> ctx) const
+{
+    return evaluate(evaluation_frame { expr, *cfg, ctx.get() });
+}
+
+float fluxins::number_ast::evaluate(const evaluation_frame &frame) const
 {
     return value;
 }
 
-float fluxins::variable_ast::evaluate(
-    const code              &expr,
-    std::shared_ptr<config>  cfg,
-    std::shared_ptr<context> ctx) const
+float fluxins::variable_ast::evaluate(const evaluation_frame &frame) const
 {
-    if (auto resolved = ctx->resolve_variable(name))
+    if (slot)
+    {
+        return *slot;
+    }
+
+    if (frame.ctx)
     {
-        return *resolved;
+        if (auto resolved = frame.ctx->resolve_variable(name))
+        {
+            return *resolved;
+        }
     }
 
-    throw unresolved_reference(name, "variable", expr, location);
+    return report_error(error_info::unresolved(name, "variable", location), frame.expr);
 }
 
-float fluxins::function_ast::evaluate(
-    const code              &expr,
-    std::shared_ptr<config>  cfg,
-    std::shared_ptr<context> ctx) const
+float fluxins::function_ast::evaluate(const evaluation_frame &frame) const
 {
-    fluxins_function function;
-
-    if (auto resolved = ctx->resolve_function(name))
+    const fluxins_function *function = target;
+    if (!function && frame.ctx)
     {
-        function = *resolved;
+        function = frame.ctx->bind_function(name);
     }
 
-    if (!function)
+    if (!function || !*function)
     {
-        throw unresolved_reference(name, "function", expr, location);
+        return report_error(error_info::unresolved(name, "function", location), frame.expr);
     }
 
     std::vector<float> evaluated_args(args.size());
     for (std::size_t i = 0; i < args.size(); i++)
     {
-        evaluated_args[i] = args[i]->evaluate(expr, cfg, ctx);
+        evaluated_args[i] = args[i]->evaluate(frame);
     }
 
-    return function(expr, location, evaluated_args);
+    return (*function)(frame.expr, location, evaluated_args);
 }
 
-float fluxins::operator_ast::evaluate(
-    const code              &expr,
-    std::shared_ptr<config>  cfg,
-    std::shared_ptr<context> ctx) const
+void fluxins::operator_ast::resolve(const config &cfg)
+{
+    index            = (std::size_t) -1;
+    resolved_config  = &cfg;
+    resolved_version = cfg.version;
+
+    if (left && right)
+    {
+        index = cfg.find_binary_op(symbol);
+    }
+    else if (left)
+    {
+        index = cfg.find_unary_suffix_op(symbol);
+    }
+    else if (right)
+    {
+        index = cfg.find_unary_prefix_op(symbol);
+    }
+}
+
+std::size_t fluxins::operator_ast::find(const config &cfg) const
 {
-    float left_value  = left ? left->evaluate(expr, cfg, ctx) : 0.0f;
-    float right_value = right ? right->evaluate(expr, cfg, ctx) : 0.0f;
+    if (resolved_config == &cfg && resolved_version == cfg.version)
+    {
+        return index;
+    }
 
     if (left && right)
     {
-        if (!cfg->binary_op_exists(symbol))
+        return cfg.find_binary_op(symbol);
+    }
+    else if (left)
+    {
+        return cfg.find_unary_suffix_op(symbol);
+    }
+    else if (right)
+    {
+        return cfg.find_unary_prefix_op(symbol);
+    }
+
+    return (std::size_t) -1;
+}
+
+float fluxins::operator_ast::evaluate(const evaluation_frame &frame) const
+{
+    float left_value  = left ? left->evaluate(frame) : 0.0f;
+    float right_value = right ? right->evaluate(frame) : 0.0f;
+
+    std::size_t op_index = find(frame.cfg);
+
+    if (left && right)
+    {
+        if (op_index == (std::size_t) -1)
         {
             // Possibly unreachable code
             // Can happen if the configuration is modified after the expression is parsed
-            throw unresolved_reference(symbol, "binary operator", expr, location);
+            return report_error(error_info::unresolved(symbol, "binary operator", location), frame.expr);
         }
 
-        const auto &op_info = cfg->get_binary_op(symbol);
-        return op_info.operate(expr, location, left_value, right_value);
+        const auto &op_info = frame.cfg.binary_operators[op_index];
+        return op_info.operate(frame.expr, location, left_value, right_value);
     }
     else if (left)
     {
-        if (!cfg->unary_suffix_op_exists(symbol))
+        if (op_index == (std::size_t) -1)
         {
             // Possibly unreachable code
             // Can happen if the configuration is modified after the expression is parsed
-            throw unresolved_reference(symbol, "unary prefix operator", expr, location);
+            return report_error(error_info::unresolved(symbol, "unary prefix operator", location), frame.expr);
         }
 
-        const auto &op_info = cfg->get_unary_suffix_op(symbol);
-        return op_info.operate(expr, location, left_value);
+        const auto &op_info = frame.cfg.unary_suffix_operators[op_index];
+        return op_info.operate(frame.expr, location, left_value);
     }
     else if (right)
     {
-        if (!cfg->unary_prefix_op_exists(symbol))
+        if (op_index == (std::size_t) -1)
         {
             // Possibly unreachable code
             // Can happen if the configuration is modified after the expression is parsed
-            throw unresolved_reference(symbol, "unary prefix operator", expr, location);
+            return report_error(error_info::unresolved(symbol, "unary prefix operator", location), frame.expr);
         }
 
-        const auto &op_info = cfg->get_unary_prefix_op(symbol);
-        return op_info.operate(expr, location, right_value);
+        const auto &op_info = frame.cfg.unary_prefix_operators[op_index];
+        return op_info.operate(frame.expr, location, right_value);
     }
 
     // Possibly unreachable code here
     // Can happen if the configuration is modified after the expression is parsed
-    throw code_error("No operands for operator was specified", expr, location);
+    return report_error({ .message = "No operands for operator was specified", .location = location }, frame.expr);
 }
 
-float fluxins::conditional_ast::evaluate(
-    const code              &expr,
-    std::shared_ptr<config>  cfg,
-    std::shared_ptr<context> ctx) const
+float fluxins::conditional_ast::evaluate(const evaluation_frame &frame) const
 {
-    float condition_value = condition->evaluate(expr, cfg, ctx);
+    float condition_value = condition->evaluate(frame);
 
     if (condition_value != 0.0f)
     {
-        return true_value->evaluate(expr, cfg, ctx);
+        return true_value->evaluate(frame);
     }
     else
     {
-        return false_value->evaluate(expr, cfg, ctx);
+        return false_value->evaluate(frame);
     }
 }
+
+float fluxins::shared_ast::evaluate(const evaluation_frame &frame) const
+{
+    return node->evaluate(frame);
+}
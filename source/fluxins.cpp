@@ -8,15 +8,24 @@
 /// This project is licensed under the terms of MIT License.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <exception>
+#include <expected>
 #include <format>
 #include <iomanip>
 #include <ios>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <print>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -24,26 +33,32 @@
 #include <utility>
 #include <vector>
 
+#include "fluxins/batch.hpp"
+#include "fluxins/bytecode.hpp"
+#include "fluxins/cache.hpp"
 #include "fluxins/code.hpp"
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
 #include "fluxins/error.hpp"
 #include "fluxins/expression.hpp"
+#include "fluxins/jit.hpp"
+#include "fluxins/optimizer.hpp"
 #include "fluxins/parser.hpp"
 
 auto default_config = std::make_shared<fluxins::config>();
 
 // Implementation
 
-void fluxins::code::randomize_name()
+void fluxins::code::randomize_name() const
 {
-    std::ostringstream oss;
-    oss << std::hex << std::setw(8) << std::setfill('0') << std::rand();
-    name = oss.str() + ".flx";
+    name = std::format("{:08x}.flx", std::rand());
 }
 
-void fluxins::code::split_lines()
+void fluxins::code::split_lines() const
 {
+    lines.clear();
+    lines_split = true;
+
     std::size_t begin = 0;
     std::size_t end   = 0;
 
@@ -62,43 +77,196 @@ void fluxins::code::split_lines()
     }
 }
 
+/// Get line number and column number from the position, if the position is
+/// in the code (see `code::get_line_col`).
+static std::optional<std::pair<std::size_t, std::size_t>> find_line_col(const fluxins::code &expr, std::size_t pos)
+{
+    const auto &index = expr.line_index();
+
+    // Last line beginning at or before the position
+    auto it = std::upper_bound(index.begin(), index.end(), pos, [](std::size_t pos, const std::pair<std::size_t, std::size_t> &line) { return pos < line.first; });
+
+    if (it == index.begin())
+    {
+        return std::nullopt;
+    }
+
+    auto [begin, length] = *--it;
+    if (pos >= begin + length)
+    {
+        // Position of the line break, or past the end of the code
+        return std::nullopt;
+    }
+
+    return std::pair { (std::size_t) std::distance(index.begin(), it) + 1, pos - begin };
+}
+
 std::pair<std::size_t, std::size_t> fluxins::code::get_line_col(std::size_t pos) const
 {
-    for (std::size_t i = 0; i < lines.size(); i++)
+    if (auto line_col = find_line_col(*this, pos))
+    {
+        return *line_col;
+    }
+
+    FLUXINS_THROW(std::out_of_range("Position is out of range"));
+}
+
+/// Add the characters of the symbol to the alphabet of the operator trie.
+static void add_to_alphabet(fluxins::operator_trie &trie, std::string_view symbol)
+{
+    for (char c : symbol)
+    {
+        auto &position = trie.alphabet[(unsigned char) c];
+        if (position != 0)
+        {
+            continue;
+        }
+
+        if (trie.alphabet_size > std::numeric_limits<std::uint8_t>::max())
+        {
+            // Possibly unreachable code
+            // Because there are only 255 characters other than '\0'
+            FLUXINS_THROW(std::length_error("Too many characters in operator symbols"));
+        }
+
+        position = (std::uint8_t) trie.alphabet_size++;
+    }
+}
+
+/// Append a new state without transitions to the operator trie.
+static std::uint32_t add_state(fluxins::operator_trie &trie)
+{
+    trie.transitions.resize(trie.transitions.size() + trie.alphabet_size, 0);
+    trie.operators.emplace_back();
+    trie.operators.back().fill((std::size_t) -1);
+    return (std::uint32_t) trie.operators.size() - 1;
+}
+
+/// Insert the symbol of the operator into the operator trie.
+/// @note The alphabet must already contain the characters of the symbol.
+static void insert_symbol(
+    fluxins::operator_trie &trie,
+    std::string_view        symbol,
+    fluxins::operator_kind  kind,
+    std::size_t             index)
+{
+    std::uint32_t state = 0;
+    for (char c : symbol)
+    {
+        std::size_t transition = state * trie.alphabet_size + trie.alphabet[(unsigned char) c];
+        if (trie.transitions[transition] == 0)
+        {
+            std::uint32_t next = add_state(trie);
+
+            // Transitions were reallocated
+            trie.transitions[transition] = next;
+        }
+
+        state = trie.transitions[transition];
+    }
+
+    // First operator with the symbol is found, like searching the list
+    auto &found = trie.operators[state][(std::size_t) kind];
+    if (found == (std::size_t) -1)
+    {
+        found = index;
+    }
+}
+
+fluxins::operator_trie fluxins::operator_trie::build(
+    const std::vector<unary_operator>  &unary_prefix_operators,
+    const std::vector<unary_operator>  &unary_suffix_operators,
+    const std::vector<binary_operator> &binary_operators)
+{
+    operator_trie trie;
+
+    // Collect the alphabet first, the size of the transition table depends on it
+    for (const auto &op : unary_prefix_operators) add_to_alphabet(trie, op.symbol);
+    for (const auto &op : unary_suffix_operators) add_to_alphabet(trie, op.symbol);
+    for (const auto &op : binary_operators) add_to_alphabet(trie, op.symbol);
+
+    add_state(trie); // Root
+
+    for (std::size_t i = 0; i < unary_prefix_operators.size(); i++)
+    {
+        insert_symbol(trie, unary_prefix_operators[i].symbol, operator_kind::unary_prefix, i);
+    }
+    for (std::size_t i = 0; i < unary_suffix_operators.size(); i++)
+    {
+        insert_symbol(trie, unary_suffix_operators[i].symbol, operator_kind::unary_suffix, i);
+    }
+    for (std::size_t i = 0; i < binary_operators.size(); i++)
+    {
+        insert_symbol(trie, binary_operators[i].symbol, operator_kind::binary, i);
+    }
+
+    return trie;
+}
+
+std::size_t fluxins::operator_trie::find(std::string_view symbol, operator_kind kind) const
+{
+    if (operators.empty())
+    {
+        return (std::size_t) -1;
+    }
+
+    std::uint32_t state = 0;
+    for (char c : symbol)
     {
-        auto [begin, length] = lines[i];
-        if (pos >= begin && pos < begin + length)
+        std::uint8_t position = alphabet[(unsigned char) c];
+        if (position == 0)
+        {
+            return (std::size_t) -1;
+        }
+
+        state = transitions[state * alphabet_size + position];
+        if (state == 0)
         {
-            return { i + 1, pos - begin };
+            return (std::size_t) -1;
         }
     }
 
-    throw std::out_of_range("Position is out of range");
+    return operators[state][(std::size_t) kind];
+}
+
+void fluxins::config::update_lookup()
+{
+    lookup         = operator_trie::build(unary_prefix_operators, unary_suffix_operators, binary_operators);
+    lookup.version = version;
 }
 
 void fluxins::config::add_unary_prefix_op(const unary_operator &op)
 {
     if (unary_prefix_op_exists(op.symbol))
     {
-        throw std::logic_error(std::format("Unary prefix operator '{}' already exists", op.symbol));
+        FLUXINS_THROW(std::logic_error(std::format("Unary prefix operator '{}' already exists", op.symbol)));
     }
 
     unary_prefix_operators.emplace_back(op);
+    version++;
+    update_lookup();
 }
 
 void fluxins::config::remove_unary_prefix_op(std::string_view symbol)
 {
     if (!unary_prefix_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find unary prefix operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find unary prefix operator '{}'", symbol)));
     }
 
     std::size_t index = find_unary_prefix_op(symbol);
     unary_prefix_operators.erase(unary_prefix_operators.begin() + index);
+    version++;
+    update_lookup();
 }
 
 std::size_t fluxins::config::find_unary_prefix_op(std::string_view symbol) const
 {
+    if (lookup.version == version)
+    {
+        return lookup.find(symbol, operator_kind::unary_prefix);
+    }
+
     auto it = std::find_if(unary_prefix_operators.begin(), unary_prefix_operators.end(), [&](const unary_operator &op) { return op.symbol == symbol; });
 
     if (it == unary_prefix_operators.end())
@@ -118,35 +286,52 @@ fluxins::unary_operator &fluxins::config::get_unary_prefix_op(std::string_view s
 {
     if (!unary_prefix_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find unary prefix operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find unary prefix operator '{}'", symbol)));
     }
 
-    return unary_prefix_operators[find_unary_prefix_op(symbol)];
+    std::size_t index = find_unary_prefix_op(symbol);
+
+    // Operator may be modified through the reference, its semantics are not
+    // known anymore and expressions compiled before are compiled again
+    unary_prefix_operators[index].builtin = intrinsic::none;
+    version++;
+    update_lookup();
+
+    return unary_prefix_operators[index];
 }
 
 void fluxins::config::add_unary_suffix_op(const unary_operator &op)
 {
     if (unary_suffix_op_exists(op.symbol))
     {
-        throw std::logic_error(std::format("Unary suffix operator '{}' already exists", op.symbol));
+        FLUXINS_THROW(std::logic_error(std::format("Unary suffix operator '{}' already exists", op.symbol)));
     }
 
     unary_suffix_operators.emplace_back(op);
+    version++;
+    update_lookup();
 }
 
 void fluxins::config::remove_unary_suffix_op(std::string_view symbol)
 {
     if (!unary_suffix_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find unary suffix operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find unary suffix operator '{}'", symbol)));
     }
 
     std::size_t index = find_unary_suffix_op(symbol);
     unary_suffix_operators.erase(unary_suffix_operators.begin() + index);
+    version++;
+    update_lookup();
 }
 
 std::size_t fluxins::config::find_unary_suffix_op(std::string_view symbol) const
 {
+    if (lookup.version == version)
+    {
+        return lookup.find(symbol, operator_kind::unary_suffix);
+    }
+
     auto it = std::find_if(unary_suffix_operators.begin(), unary_suffix_operators.end(), [&](const unary_operator &op) { return op.symbol == symbol; });
 
     if (it == unary_suffix_operators.end())
@@ -166,40 +351,74 @@ fluxins::unary_operator &fluxins::config::get_unary_suffix_op(std::string_view s
 {
     if (!unary_suffix_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find unary suffix operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find unary suffix operator '{}'", symbol)));
     }
 
-    return unary_suffix_operators[find_unary_suffix_op(symbol)];
+    std::size_t index = find_unary_suffix_op(symbol);
+
+    // Operator may be modified through the reference, its semantics are not
+    // known anymore and expressions compiled before are compiled again
+    unary_suffix_operators[index].builtin = intrinsic::none;
+    version++;
+    update_lookup();
+
+    return unary_suffix_operators[index];
 }
 
 void fluxins::config::add_binary_op(const binary_operator &op)
 {
     if (binary_op_exists(op.symbol))
     {
-        throw std::logic_error(std::format("Binary operator '{}' already exists", op.symbol));
+        FLUXINS_THROW(std::logic_error(std::format("Binary operator '{}' already exists", op.symbol)));
     }
 
     if (op.assoc == associativity::max)
     {
-        throw std::logic_error(std::format("Binary operator '{}' has invalid associativity '{}'", op.symbol, associativity_to_string(op.assoc)));
+        FLUXINS_THROW(std::logic_error(std::format("Binary operator '{}' has invalid associativity '{}'", op.symbol, associativity_to_string(op.assoc))));
     }
 
     binary_operators.emplace_back(op);
+    version++;
+    update_lookup();
+    update_bindings();
 }
 
 void fluxins::config::remove_binary_op(std::string_view symbol)
 {
     if (!binary_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol)));
     }
 
+    unassign_precedence(symbol);
+
     std::size_t index = find_binary_op(symbol);
     binary_operators.erase(binary_operators.begin() + index);
+
+    // Operators after the removed one are shifted down
+    for (auto &row : binary_op_precedence)
+    {
+        for (std::size_t &i : row)
+        {
+            if (i > index)
+            {
+                i--;
+            }
+        }
+    }
+
+    version++;
+    update_lookup();
+    update_bindings();
 }
 
 std::size_t fluxins::config::find_binary_op(std::string_view symbol) const
 {
+    if (lookup.version == version)
+    {
+        return lookup.find(symbol, operator_kind::binary);
+    }
+
     auto it = std::find_if(binary_operators.begin(), binary_operators.end(), [&](const binary_operator &op) { return op.symbol == symbol; });
 
     if (it == binary_operators.end())
@@ -219,10 +438,19 @@ fluxins::binary_operator &fluxins::config::get_binary_op(std::string_view symbol
 {
     if (!binary_op_exists(symbol))
     {
-        throw std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol)));
     }
 
-    return binary_operators[find_binary_op(symbol)];
+    std::size_t index = find_binary_op(symbol);
+
+    // Operator may be modified through the reference, its semantics are not
+    // known anymore and expressions parsed before must not be copied from the
+    // cache
+    binary_operators[index].builtin = intrinsic::none;
+    version++;
+    update_lookup();
+
+    return binary_operators[index];
 }
 
 void fluxins::config::assign_precedence(
@@ -235,7 +463,7 @@ void fluxins::config::assign_precedence(
 
     if (index == (std::size_t) -1)
     {
-        throw std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol)));
     }
 
     // Check if the operator is already in the precedence level
@@ -250,7 +478,7 @@ void fluxins::config::assign_precedence(
 
         if (!override)
         {
-            throw std::logic_error(std::format("Operator '{}' already exists in precedence level {}", symbol, i));
+            FLUXINS_THROW(std::logic_error(std::format("Operator '{}' already exists in precedence level {}", symbol, i)));
         }
 
         row.erase(found_in_row);
@@ -273,7 +501,7 @@ void fluxins::config::assign_precedence(
     {
         if (precedence > binary_op_precedence.size())
         {
-            throw std::out_of_range(std::format("Cannot insert precedence level {}, it is out of range", precedence));
+            FLUXINS_THROW(std::out_of_range(std::format("Cannot insert precedence level {}, it is out of range", precedence)));
         }
 
         binary_op_precedence.insert(binary_op_precedence.begin() + precedence, std::vector<std::size_t>());
@@ -281,10 +509,15 @@ void fluxins::config::assign_precedence(
 
     if (precedence >= binary_op_precedence.size())
     {
-        throw std::out_of_range(std::format("Cannot assign precedence level {}, it is out of range", precedence));
+        FLUXINS_THROW(std::out_of_range(std::format("Cannot assign precedence level {}, it is out of range", precedence)));
     }
 
     binary_op_precedence[precedence].emplace_back(index);
+    update_bindings();
+
+    // Expressions parsed with the previous precedence are parsed differently
+    version++;
+    update_lookup();
 }
 
 void fluxins::config::assign_precedence(
@@ -297,15 +530,13 @@ void fluxins::config::assign_precedence(
 
 void fluxins::config::unassign_precedence(std::string_view symbol)
 {
-    auto it = std::find_if(binary_operators.begin(), binary_operators.end(), [&](const binary_operator &op) { return op.symbol == symbol; });
+    std::size_t index = find_binary_op(symbol);
 
-    if (it == binary_operators.end())
+    if (index == (std::size_t) -1)
     {
-        throw std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol));
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol)));
     }
 
-    std::size_t index = std::distance(binary_operators.begin(), it);
-
     for (std::size_t i = 0; i < binary_op_precedence.size(); i++)
     {
         auto &row   = binary_op_precedence[i];
@@ -323,18 +554,42 @@ void fluxins::config::unassign_precedence(std::string_view symbol)
 
         break; // We know the operator is only in one precedence level
     }
+
+    update_bindings();
+
+    // Expressions parsed with the previous precedence are parsed differently
+    version++;
+    update_lookup();
 }
 
-std::size_t fluxins::config::get_precedence(std::string_view symbol) const
+void fluxins::config::update_bindings()
 {
-    auto it = std::find_if(binary_operators.begin(), binary_operators.end(), [&](const binary_operator &op) { return op.symbol == symbol; });
+    binary_op_bindings.assign(binary_operators.size(), {});
 
-    if (it == binary_operators.end())
+    std::size_t levels = binary_op_precedence.size();
+    for (std::size_t i = 0; i < levels; i++)
     {
-        throw std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol));
+        for (std::size_t index : binary_op_precedence[i])
+        {
+            // Can happen if the precedence table is modified directly
+            if (index >= binary_operators.size())
+            {
+                continue;
+            }
+
+            binary_op_bindings[index].power = levels - i;
+        }
     }
+}
 
-    std::size_t index = std::distance(binary_operators.begin(), it);
+std::size_t fluxins::config::get_precedence(std::string_view symbol) const
+{
+    std::size_t index = find_binary_op(symbol);
+
+    if (index == (std::size_t) -1)
+    {
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find binary operator '{}'", symbol)));
+    }
 
     for (std::size_t i = 0; i < binary_op_precedence.size(); i++)
     {
@@ -349,6 +604,39 @@ std::size_t fluxins::config::get_precedence(std::string_view symbol) const
     return (std::size_t) -1;
 }
 
+/// Number of structural changes made to all contexts.
+static std::atomic<std::size_t> epoch = 0;
+
+std::size_t fluxins::context_epoch()
+{
+    return epoch.load(std::memory_order_relaxed);
+}
+
+std::size_t fluxins::advance_context_epoch()
+{
+    return epoch.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+std::size_t fluxins::context::revision() const
+{
+    std::size_t latest = std::max({ version, variables.version, functions.version, traits.version });
+    for (const auto &parent : parents)
+    {
+        latest = std::max(latest, parent->revision());
+    }
+    return latest;
+}
+
+std::size_t fluxins::context::function_revision() const
+{
+    std::size_t latest = std::max({ version, functions.version, traits.version });
+    for (const auto &parent : parents)
+    {
+        latest = std::max(latest, parent->function_revision());
+    }
+    return latest;
+}
+
 std::optional<fluxins::fluxins_variable> fluxins::context::resolve_variable(const std::string &name) const
 {
     if (variables.contains(name))
@@ -367,6 +655,24 @@ std::optional<fluxins::fluxins_variable> fluxins::context::resolve_variable(cons
     return std::nullopt;
 }
 
+fluxins::fluxins_variable *fluxins::context::bind_variable(const std::string &name)
+{
+    if (auto found = variables.find(name); found != variables.end())
+    {
+        return &found->second;
+    }
+
+    for (const auto &parent : parents)
+    {
+        if (auto bound = parent->bind_variable(name))
+        {
+            return bound;
+        }
+    }
+
+    return nullptr;
+}
+
 std::optional<fluxins::fluxins_function> fluxins::context::resolve_function(const std::string &name) const
 {
     if (functions.contains(name))
@@ -385,6 +691,68 @@ std::optional<fluxins::fluxins_function> fluxins::context::resolve_function(cons
     return std::nullopt;
 }
 
+const fluxins::fluxins_function *fluxins::context::bind_function(const std::string &name) const
+{
+    if (auto found = functions.find(name); found != functions.end())
+    {
+        return &found->second;
+    }
+
+    for (const auto &parent : parents)
+    {
+        if (auto bound = parent->bind_function(name))
+        {
+            return bound;
+        }
+    }
+
+    return nullptr;
+}
+
+std::optional<fluxins::vector_function> fluxins::context::resolve_vector_function(const std::string &name) const
+{
+    if (functions.contains(name))
+    {
+        if (vector_functions.contains(name))
+        {
+            return vector_functions.at(name);
+        }
+        return std::nullopt;
+    }
+
+    for (const auto &parent : parents)
+    {
+        if (parent->bind_function(name))
+        {
+            return parent->resolve_vector_function(name);
+        }
+    }
+
+    return std::nullopt;
+}
+
+fluxins::function_traits fluxins::context::resolve_function_traits(const std::string &name) const
+{
+    if (functions.contains(name))
+    {
+        if (traits.contains(name))
+        {
+            return traits.at(name);
+        }
+        return {};
+    }
+
+    for (const auto &parent : parents)
+    {
+        if (parent->bind_function(name))
+        {
+            return parent->resolve_function_traits(name);
+        }
+    }
+
+    return {};
+}
+
 std::string fluxins::code_location::preview_text(const code &expr, int padding) const
 {
     std::size_t begin_pos   = begin;
@@ -396,6 +764,8 @@ std::string fluxins::code_location::preview_text(const code &expr, int padding)
     auto [pointer_line, pointer_col] = expr.get_line_col(pointer_pos);
     std::size_t end_col_exc          = end_col_inc + 1;
 
+    const auto &lines = expr.line_index();
+
     // Width for the line‑number column
     std::size_t        width = std::to_string(end_line).length();
     std::ostringstream out;
@@ -407,14 +777,14 @@ std::string fluxins::code_location::preview_text(const code &expr, int padding)
         out << std::string(padding, ' ');
 
         out << std::setw(width) << ln << " | "
-            << expr.expr.substr(expr.lines[ln - 1].first, expr.lines[ln - 1].second)
+            << expr.expr.substr(lines[ln - 1].first, lines[ln - 1].second)
             << "\n";
 
         // Marker line
         out << std::string(padding, ' ');
 
         out << std::string(width, ' ') << " | ";
-        auto [_, line_len] = expr.lines[ln - 1];
+        auto [_, line_len] = lines[ln - 1];
         std::size_t start  = (ln == begin_line ? begin_col : 0);
         std::size_t end    = (ln == end_line ? end_col_exc : line_len);
 
@@ -436,48 +806,429 @@ std::string fluxins::code_location::preview_text(const code &expr, int padding)
     return out.str();
 }
 
+/// Get the formatted message of the error in the code (see `code_error`).
+///
+/// Locations outside of the code are formatted without line and column numbers
+/// and preview text.
+static std::string format_error(const fluxins::code &expr, std::string_view message, fluxins::code_location location)
+{
+    std::size_t last    = location.begin + (location.length ? location.length - 1 : 0);
+    std::size_t pointer = location.begin + location.pointer;
+
+    auto begin = find_line_col(expr, location.begin);
+    auto end   = find_line_col(expr, last);
+    if (!begin || !end || !find_line_col(expr, pointer) || location.length == 0)
+    {
+        return std::format("{}: {}\n", expr.get_name(), message);
+    }
+
+    return std::format(
+        "{}: {}:{}-{}:{}: {}\n{}",
+        expr.get_name(),
+        begin->first,
+        begin->second,
+        end->first,
+        end->second,
+        message,
+        location.preview_text(expr));
+}
+
+void fluxins::terminate(const std::exception &exception)
+{
+    std::println(stderr, "{}", exception.what());
+    std::abort();
+}
+
+std::string fluxins::error_info::format(const code &expr) const
+{
+    return format_error(expr, message, location);
+}
+
+void fluxins::error_info::raise(const code &expr) const
+{
+    switch (kind)
+    {
+        case error_kind::invalid_arity:
+            FLUXINS_THROW(fluxins::invalid_arity(*this, expr));
+        case error_kind::tokenizer_error:
+            FLUXINS_THROW(fluxins::tokenizer_error(*this, expr));
+        case error_kind::unexpected_token:
+            FLUXINS_THROW(fluxins::unexpected_token(*this, expr));
+        case error_kind::unresolved_reference:
+            FLUXINS_THROW(fluxins::unresolved_reference(*this, expr));
+        case error_kind::exception:
+            FLUXINS_THROW(std::runtime_error(message));
+        default:
+            FLUXINS_THROW(code_error(*this, expr));
+    }
+}
+
+fluxins::error_info fluxins::error_info::from(const code_error &error)
+{
+    error_info info = { error.kind, error.message, error.location };
+
+    if (auto arity_error = dynamic_cast<const invalid_arity *>(&error))
+    {
+        info.symbol     = arity_error->function;
+        info.args_count = arity_error->args_count;
+        info.arity      = arity_error->arity;
+    }
+    else if (auto token_error = dynamic_cast<const fluxins::unexpected_token *>(&error))
+    {
+        info.unexpected = token_error->unexpected;
+    }
+    else if (auto reference_error = dynamic_cast<const unresolved_reference *>(&error))
+    {
+        info.symbol      = reference_error->symbol;
+        info.symbol_type = reference_error->type;
+    }
+
+    return info;
+}
+
+fluxins::error_info fluxins::error_info::arity_mismatch(std::string_view function, std::size_t args_count, std::size_t arity, code_location location)
+{
+    return {
+        .kind       = error_kind::invalid_arity,
+        .message    = std::format("Function '{}' requires {} arguments, but got {}", function, arity, args_count),
+        .location   = location,
+        .symbol     = std::string(function),
+        .args_count = args_count,
+        .arity      = arity,
+    };
+}
+
+fluxins::error_info fluxins::error_info::unresolved(std::string_view symbol, std::string_view type, code_location location)
+{
+    return {
+        .kind        = error_kind::unresolved_reference,
+        .message     = std::format("Unresolved reference to {} '{}'", type, symbol),
+        .location    = location,
+        .symbol      = std::string(symbol),
+        .symbol_type = std::string(type),
+    };
+}
+
+fluxins::error_info fluxins::error_info::unexpected_at(std::string_view message, const token &unexpected)
+{
+    return {
+        .kind       = error_kind::unexpected_token,
+        .message    = std::string(message),
+        .location   = unexpected.location,
+        .unexpected = std::make_shared<token>(unexpected),
+    };
+}
+
+/// Innermost active error sink on this thread.
+static thread_local fluxins::error_sink *active_sink = nullptr;
+
+fluxins::error_sink::error_sink() : previous(active_sink)
+{
+    active_sink = this;
+}
+
+fluxins::error_sink::~error_sink()
+{
+    active_sink = previous;
+}
+
+fluxins::error_sink *fluxins::error_sink::active()
+{
+    return active_sink;
+}
+
+float fluxins::report_error(error_info error, const code &expr)
+{
+    if (!active_sink)
+    {
+        error.raise(expr);
+    }
+
+    if (!active_sink->error)
+    {
+        active_sink->error = std::move(error);
+    }
+
+    return std::numeric_limits<float>::quiet_NaN();
+}
+
 fluxins::code_error::code_error(std::string_view message, const code &expr, code_location location)
-try
-    : message(message), expr(expr), location(location)
+    : message(message), expr(expr), location(location), formatted_message(format_error(this->expr, message, location))
 {
-    std::ostringstream oss;
-    auto [begin_line, begin_col] = expr.get_line_col(location.begin);
-    auto [end_line, end_col]     = expr.get_line_col(location.begin + location.length - 1);
-    oss << expr.name << ": "
-        << begin_line << ":" << begin_col << "-"
-        << end_line << ":" << end_col << ": "
-        << message << "\n"
-        << location.preview_text(expr);
-    formatted_message = oss.str();
 }
-catch (const std::exception &e)
+
+fluxins::code_error::code_error(const error_info &error, const code &expr)
+    : code_error(error.message, expr, error.location)
 {
+    kind = error.kind;
 }
 
 fluxins::invalid_arity::invalid_arity(std::string_view function, std::size_t args_count, std::size_t arity, const code &expr, code_location location)
-    : code_error(std::format("Function '{}' requires {} arguments, but got {}", function, arity, args_count), expr, location)
+    : invalid_arity(error_info::arity_mismatch(function, args_count, arity, location), expr)
+{
+}
+
+fluxins::invalid_arity::invalid_arity(const error_info &error, const code &expr)
+    : code_error(error, expr), function(error.symbol), args_count(error.args_count), arity(error.arity)
 {
+    kind = error_kind::invalid_arity;
 }
 
 fluxins::tokenizer_error::tokenizer_error(std::string_view message, const code &expr, code_location location)
     : code_error(message, expr, location)
 {
+    kind = error_kind::tokenizer_error;
+}
+
+fluxins::tokenizer_error::tokenizer_error(const error_info &error, const code &expr)
+    : code_error(error, expr)
+{
+    kind = error_kind::tokenizer_error;
 }
 
 fluxins::unexpected_token::unexpected_token(std::string_view messsage, const code &expr, const token &token)
-    : code_error(messsage, expr, token.location)
+    : unexpected_token(error_info::unexpected_at(messsage, token), expr)
 {
 }
 
+fluxins::unexpected_token::unexpected_token(std::string_view messsage, const code &expr, const packed_token &token)
+    : unexpected_token(messsage, expr, token.unpack(expr))
+{
+}
+
+fluxins::unexpected_token::unexpected_token(const error_info &error, const code &expr)
+    : code_error(error, expr), unexpected(error.unexpected)
+{
+    kind = error_kind::unexpected_token;
+}
+
 fluxins::unresolved_reference::unresolved_reference(std::string_view name, std::string_view type, const code &expr, code_location location)
-    : code_error(std::format("Unresolved reference to {} '{}'", type, name), expr, location)
+    : unresolved_reference(error_info::unresolved(name, type, location), expr)
+{
+}
+
+fluxins::unresolved_reference::unresolved_reference(const error_info &error, const code &expr)
+    : code_error(error, expr), symbol(error.symbol), type(error.symbol_type)
+{
+    kind = error_kind::unresolved_reference;
+}
+
+/// Record the variables read by the expression and their values, so that the
+/// expression is not evaluated again until they change.
+static void track_dependencies(fluxins::expression &expr)
+{
+    if (!expr.ast)
+    {
+        return;
+    }
+
+    std::size_t epoch    = fluxins::context_epoch();
+    std::size_t revision = expr.ctx->revision();
+
+    // Symbols are only collected and bound again when the context changed
+    if (expr.tracked_ctx != expr.ctx.get() || expr.tracked_revision != revision)
+    {
+        fluxins::ast_symbols symbols;
+        expr.ast->collect_symbols(symbols);
+
+        expr.dependencies.clear();
+        for (const auto &name : symbols.variables)
+        {
+            expr.dependencies.emplace_back(fluxins::variable_dependency { .name = name, .handle = expr.ctx->bind_variable(name) });
+        }
+
+        expr.impure = std::any_of(symbols.functions.begin(), symbols.functions.end(), [&](const std::string &name) { return !expr.ctx->resolve_function_traits(name).pure; });
+
+        expr.tracked_ctx      = expr.ctx.get();
+        expr.tracked_revision = revision;
+    }
+    expr.tracked_epoch = epoch;
+
+    for (auto &dependency : expr.dependencies)
+    {
+        if (dependency.handle)
+        {
+            dependency.value = *dependency.handle;
+        }
+    }
+}
+
+/// Compile the expression again when the config was modified after compiling,
+/// since the operators of the bytecode are indices into the lists of operators
+/// of the config. Bound and native code is bound and compiled again as well.
+/// @return False when compiling failed and the error was collected.
+static bool recompile_if_stale(fluxins::expression &expr)
+{
+    const fluxins::config &cfg = expr.cfg ? *expr.cfg : *default_config;
+    if (expr.program.instructions.empty() || expr.program.version == cfg.version)
+    {
+        return true;
+    }
+
+    bool bound  = !expr.program.variables.empty();
+    bool native = expr.native != nullptr;
+
+    expr.compile();
+
+    // Partially compiled program cannot be executed
+    const fluxins::error_sink *sink = fluxins::error_sink::active();
+    if (sink && sink->error)
+    {
+        expr.program = {};
+        return false;
+    }
+
+    if (bound)
+    {
+        fluxins::bind(expr.program, expr.ctx);
+    }
+    if (native)
+    {
+        expr.compile_native();
+    }
+    return true;
+}
+
+/// Optimize the expression again from the parsed AST when functions were
+/// modified after optimizing, since calls to pure functions may be folded or
+/// shared. Compiled, native and bound code is compiled and bound again as well.
+/// @return False when an error was collected.
+static bool reoptimize_if_stale(fluxins::expression &expr)
 {
+    if (!expr.optimized)
+    {
+        return true;
+    }
+
+    // Revision can only have changed when any context changed structurally
+    std::size_t epoch = fluxins::context_epoch();
+    if (expr.optimized_ctx == expr.ctx.get() && (expr.optimized_epoch == epoch || expr.ctx->function_revision() <= expr.optimized_epoch))
+    {
+        expr.optimized_epoch = epoch;
+        return true;
+    }
+
+    bool compiled = !expr.program.instructions.empty();
+    bool native   = expr.native != nullptr;
+    bool bound    = expr.bound_ctx != nullptr;
+
+    // Following stages cannot continue with the result of a failed stage
+    const fluxins::error_sink *sink   = fluxins::error_sink::active();
+    auto                       failed = [&] { return sink && sink->error; };
+
+    expr.parse();
+    if (!failed()) expr.optimize();
+    if (!failed() && compiled) expr.compile();
+    if (!failed() && native) expr.compile_native();
+    if (!failed() && bound) expr.bind();
+
+    if (failed())
+    {
+        // Parsed again on the next evaluation
+        expr.program       = {};
+        expr.native        = nullptr;
+        expr.optimized     = true;
+        expr.optimized_ctx = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/// Bind the expression again when symbols were added to or removed from the
+/// context after binding, since the handles may point to shadowed or removed
+/// symbols then.
+static void rebind_if_stale(fluxins::expression &expr)
+{
+    if (!expr.bound_ctx)
+    {
+        return;
+    }
+
+    // Revision can only have changed when any context changed structurally
+    std::size_t epoch = fluxins::context_epoch();
+    if (expr.bound_ctx == expr.ctx.get() && (expr.bound_epoch == epoch || expr.ctx->revision() <= expr.bound_epoch))
+    {
+        expr.bound_epoch = epoch;
+        return;
+    }
+
+    expr.bind();
 }
 
 void fluxins::expression::parse()
 {
-    tokens = tokenize(expr);
-    ast    = ::fluxins::parse(expr, tokens, cfg ? cfg : default_config);
+    // Cached AST is shared, the copy can be optimized and bound
+    if (auto parsed = global_cache().parse(expr, cfg ? cfg : default_config))
+    {
+        tokens = parsed->tokens;
+        ast    = parsed->ast->clone();
+    }
+    else
+    {
+        tokens = {};
+        ast    = nullptr;
+    }
+
+    // Old bytecode is stale now
+    program     = {};
+    native      = nullptr;
+    tracked_ctx = nullptr;
+    bound_ctx   = nullptr;
+    optimized   = false;
+}
+
+void fluxins::expression::optimize()
+{
+    if (!ctx)
+    {
+        ctx = std::make_shared<context>();
+    }
+
+    ast = fold_constants(expr, ast, cfg ? cfg : default_config, ctx);
+    ast = eliminate_common_subexpressions(ast, ctx);
+
+    // Old bytecode is stale now
+    program         = {};
+    native          = nullptr;
+    tracked_ctx     = nullptr;
+    optimized       = true;
+    optimized_ctx   = ctx.get();
+    optimized_epoch = context_epoch();
+}
+
+void fluxins::expression::bind()
+{
+    if (!ctx)
+    {
+        ctx = std::make_shared<context>();
+    }
+
+    ast->bind(ctx);
+    if (!program.instructions.empty())
+    {
+        ::fluxins::bind(program, ctx);
+    }
+    tracked_ctx = nullptr;
+    bound_ctx   = ctx.get();
+    bound_epoch = context_epoch();
+}
+
+void fluxins::expression::compile()
+{
+    program     = ::fluxins::compile(expr, ast, cfg ? cfg : default_config);
+    native      = nullptr;
+    tracked_ctx = nullptr;
+}
+
+void fluxins::expression::compile_native()
+{
+    if (program.instructions.empty())
+    {
+        compile();
+    }
+
+    native      = jit_compile(program, cfg ? cfg : default_config);
+    tracked_ctx = nullptr;
 }
 
 void fluxins::expression::evaluate()
@@ -486,5 +1237,298 @@ void fluxins::expression::evaluate()
     {
         ctx = std::make_shared<context>();
     }
-    value = ast->evaluate(expr, cfg ? cfg : default_config, ctx);
+
+    if (!reoptimize_if_stale(*this) || !recompile_if_stale(*this))
+    {
+        return;
+    }
+    rebind_if_stale(*this);
+
+    if (!outdated())
+    {
+        // Revision is unchanged, no need to compute it until a context changes
+        tracked_epoch = context_epoch();
+        return;
+    }
+
+    if (native)
+    {
+        value = jit_execute(*native, program, expr, cfg ? cfg : default_config, ctx);
+    }
+    else if (!program.instructions.empty())
+    {
+        value = execute(program, expr, cfg ? cfg : default_config, ctx);
+    }
+    else
+    {
+        value = ast->evaluate(evaluation_frame { expr, cfg ? *cfg : *default_config, ctx.get() });
+    }
+
+    // Value is not valid after a collected error
+    const error_sink *sink = error_sink::active();
+    if (!sink || !sink->error)
+    {
+        track_dependencies(*this);
+    }
+}
+
+bool fluxins::expression::outdated() const
+{
+    if (!tracked_ctx || tracked_ctx != ctx.get() || impure)
+    {
+        return true;
+    }
+
+    // Revision can only have changed when any context changed structurally
+    if (tracked_epoch != context_epoch() && tracked_revision != ctx->revision())
+    {
+        return true;
+    }
+
+    // Compared bitwise, so that NaN equals NaN
+    return std::any_of(dependencies.begin(), dependencies.end(), [](const variable_dependency &dependency) {
+        return dependency.handle && std::bit_cast<std::uint32_t>(*dependency.handle) != std::bit_cast<std::uint32_t>(dependency.value);
+    });
+}
+
+std::expected<float, fluxins::error_info> fluxins::expression::try_evaluate()
+{
+    float previous = value;
+
+    auto result = collect_errors([&] {
+        evaluate();
+        return value;
+    });
+
+    if (!result)
+    {
+        value = previous;
+    }
+    return result;
+}
+
+std::expected<float, fluxins::error_info> fluxins::expression::try_get_value()
+{
+    if (ast)
+    {
+        return value;
+    }
+
+    auto result = collect_errors([&] {
+        // Following stages cannot continue with the result of a failed stage
+        const error_sink &sink = *error_sink::active();
+
+        parse();
+        if (!sink.error) optimize();
+        if (!sink.error) compile();
+        if (!sink.error) bind();
+        if (!sink.error) evaluate();
+        return value;
+    });
+
+    if (!result)
+    {
+        ast         = nullptr;
+        program     = {};
+        native      = nullptr;
+        value       = 0.0f;
+        tracked_ctx = nullptr;
+        bound_ctx   = nullptr;
+        optimized   = false;
+    }
+    return result;
+}
+
+void fluxins::expression::evaluate_batch(std::span<const column> columns, std::span<float> output)
+{
+    if (!ctx)
+    {
+        ctx = std::make_shared<context>();
+    }
+
+    if (!reoptimize_if_stale(*this))
+    {
+        return;
+    }
+
+    if (program.instructions.empty())
+    {
+        compile();
+    }
+    else if (!recompile_if_stale(*this))
+    {
+        return;
+    }
+
+    execute_batch(program, expr, cfg ? cfg : default_config, ctx, columns, output);
+}
+
+/// Scratch space for evaluating compiled expressions, reused by each thread.
+struct evaluation_scratch {
+    std::vector<float>                             stack;          ///< Stack and locals.
+    std::vector<float>                             args;           ///< Function arguments.
+    std::vector<const fluxins::fluxins_variable *> variables;      ///< Value of the variable of each name.
+    bool                                           in_use = false; ///< True while evaluating.
+};
+
+/// Scratch space of this thread.
+static thread_local evaluation_scratch thread_scratch;
+
+/// Marks the scratch space as not in use when the evaluation ends (even when
+/// an exception is thrown).
+struct scratch_guard {
+    evaluation_scratch &scratch;
+
+    ~scratch_guard()
+    {
+        scratch.in_use = false;
+    }
+};
+
+std::size_t fluxins::compiled_expression::find_variable(std::string_view name) const
+{
+    auto it = std::find(variables.begin(), variables.end(), name);
+    if (it == variables.end())
+    {
+        return (std::size_t) -1;
+    }
+
+    return std::distance(variables.begin(), it);
+}
+
+float fluxins::compiled_expression::evaluate(const context *ctx) const
+{
+    return evaluate({}, ctx);
+}
+
+float fluxins::compiled_expression::evaluate(std::span<const float> values, const context *ctx) const
+{
+    // Functions called by the expression can evaluate compiled expressions as
+    // well, which use their own scratch space
+    evaluation_scratch  own_scratch;
+    evaluation_scratch &scratch = thread_scratch.in_use ? own_scratch : thread_scratch;
+    scratch.in_use              = true;
+    scratch_guard guard { scratch };
+
+    if (scratch.stack.size() < program.max_stack + program.locals)
+    {
+        scratch.stack.resize(program.max_stack + program.locals);
+    }
+
+    scratch.variables.assign(program.names.size(), nullptr);
+    for (std::size_t i = 0; i < program.names.size(); i++)
+    {
+        if (variable_indices[i] < values.size())
+        {
+            scratch.variables[i] = &values[variable_indices[i]];
+        }
+    }
+
+    return execute(program, expr, *cfg, ctx, scratch.variables.data(), scratch.stack.data(), scratch.args);
+}
+
+std::expected<float, fluxins::error_info> fluxins::compiled_expression::try_evaluate(const context *ctx) const
+{
+    return collect_errors([&] { return evaluate(ctx); });
+}
+
+std::expected<float, fluxins::error_info> fluxins::compiled_expression::try_evaluate(std::span<const float> values, const context *ctx) const
+{
+    return collect_errors([&] { return evaluate(values, ctx); });
+}
+
+std::shared_ptr<const fluxins::compiled_expression> fluxins::compiled_expression::specialize(
+    const fluxins_variables &values,
+    std::shared_ptr<context> ctx) const
+{
+    // Specialized from the code, along with the previous constants
+    fluxins_variables merged = constants;
+    for (const auto &[name, value] : values)
+    {
+        merged.insert_or_assign(name, value);
+    }
+
+    return specialize_expression(expr, merged, cfg, ctx);
+}
+
+std::shared_ptr<const fluxins::compiled_expression> fluxins::compile_expression(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    return specialize_expression(expr, {}, cfg, ctx);
+}
+
+std::shared_ptr<const fluxins::compiled_expression> fluxins::specialize_expression(
+    const code              &expr,
+    const fluxins_variables &constants,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    auto compiled       = std::make_shared<compiled_expression>();
+    compiled->expr      = expr;
+    compiled->cfg       = cfg ? cfg : default_config;
+    compiled->constants = constants;
+
+    // Results of the stages after a collected error are not valid
+    const error_sink *sink = error_sink::active();
+
+    // Cached AST is shared, the copy can be optimized
+    auto parsed = global_cache().parse(compiled->expr, compiled->cfg);
+    if (!parsed)
+    {
+        return nullptr;
+    }
+
+    auto ast          = substitute_variables(parsed->ast->clone(), constants);
+    ast               = fold_constants(compiled->expr, ast, compiled->cfg, ctx);
+    ast               = eliminate_common_subexpressions(ast, ctx);
+    compiled->program = compile(compiled->expr, ast, compiled->cfg);
+    if (sink && sink->error)
+    {
+        return nullptr;
+    }
+
+    // Variables are numbered in the order they are first read
+    compiled->variable_indices.assign(compiled->program.names.size(), (std::size_t) -1);
+    for (const instruction &inst : compiled->program.instructions)
+    {
+        if (inst.op == opcode::load_variable && compiled->variable_indices[inst.operand] == (std::size_t) -1)
+        {
+            compiled->variable_indices[inst.operand] = compiled->variables.size();
+            compiled->variables.emplace_back(compiled->program.names[inst.operand]);
+        }
+    }
+
+    return compiled;
+}
+
+/// Parse (or find in the cache of parsed expressions) and evaluate the code
+/// once.
+/// @return Value, or NaN when an error is collected.
+static float express_once(
+    const fluxins::code             &expr,
+    std::shared_ptr<fluxins::config> cfg,
+    const fluxins::context          *ctx)
+{
+    // Cached AST is evaluated without modifying it
+    auto parsed = fluxins::global_cache().parse(expr, cfg);
+    if (!parsed)
+    {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+
+    return parsed->ast->evaluate(fluxins::evaluation_frame { expr, *cfg, ctx });
+}
+
+float fluxins::express(std::string_view expr, std::shared_ptr<config> cfg, std::shared_ptr<context> ctx)
+{
+    code source = expr;
+    return express_once(source, cfg ? cfg : default_config, ctx.get());
+}
+
+std::expected<float, fluxins::error_info> fluxins::try_express(std::string_view expr, std::shared_ptr<config> cfg, std::shared_ptr<context> ctx)
+{
+    code source = expr;
+    return collect_errors([&] { return express_once(source, cfg ? cfg : default_config, ctx.get()); });
 }
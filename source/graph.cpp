@@ -0,0 +1,303 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for the graph of named
+/// expressions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/graph.hpp"
+#include "fluxins/parallel.hpp"
+#include "fluxins/parser.hpp"
+
+/// Check if the target is the node or downstream of the node.
+static bool reaches(const fluxins::graph_node *node, const fluxins::graph_node *target)
+{
+    std::vector<const fluxins::graph_node *>        pending = { node };
+    std::unordered_set<const fluxins::graph_node *> visited = { node };
+
+    while (!pending.empty())
+    {
+        const fluxins::graph_node *current = pending.back();
+        pending.pop_back();
+
+        if (current == target)
+        {
+            return true;
+        }
+
+        for (const fluxins::graph_node *output : current->outputs)
+        {
+            if (visited.insert(output).second)
+            {
+                pending.emplace_back(output);
+            }
+        }
+    }
+
+    return false;
+}
+
+/// Remove the node from the list of nodes.
+static void unlink(std::vector<fluxins::graph_node *> &list, const fluxins::graph_node *node)
+{
+    list.erase(std::remove(list.begin(), list.end(), node), list.end());
+}
+
+/// Update the level of the node, and of the nodes downstream whose level
+/// changes as a result.
+static void update_levels(fluxins::graph_node &node)
+{
+    std::vector<fluxins::graph_node *> pending = { &node };
+
+    while (!pending.empty())
+    {
+        fluxins::graph_node *current = pending.back();
+        pending.pop_back();
+
+        std::size_t level = 0;
+        for (const fluxins::graph_node *input : current->inputs)
+        {
+            level = std::max(level, input->level + 1);
+        }
+
+        // Outputs of the node itself may have changed
+        if (level == current->level && current != &node)
+        {
+            continue;
+        }
+
+        current->level = level;
+        pending.insert(pending.end(), current->outputs.begin(), current->outputs.end());
+    }
+}
+
+fluxins::expression_graph::expression_graph(std::shared_ptr<config> cfg, std::shared_ptr<context> ctx)
+    : cfg(cfg), ctx(ctx ? ctx : std::make_shared<context>())
+{
+}
+
+fluxins::graph_node &fluxins::expression_graph::set_node(const std::string &name, const code &expr)
+{
+    // Prepared before modifying the graph, which is left unchanged on errors
+    expression prepared(expr, cfg, ctx);
+    prepared.parse();
+    prepared.optimize();
+    prepared.compile();
+
+    ast_symbols symbols;
+    prepared.ast->collect_symbols(symbols);
+
+    graph_node *existing = find_node(name);
+
+    // Nodes that read the node, which are not linked when the node is new
+    std::vector<graph_node *> readers;
+    if (existing)
+    {
+        readers = existing->outputs;
+    }
+    else
+    {
+        for (auto &[other_name, other] : nodes)
+        {
+            if (std::find(other.symbols.variables.begin(), other.symbols.variables.end(), name) != other.symbols.variables.end())
+            {
+                readers.emplace_back(&other);
+            }
+        }
+    }
+
+    std::vector<graph_node *> inputs;
+    for (const auto &variable : symbols.variables)
+    {
+        if (variable == name)
+        {
+            FLUXINS_THROW(std::logic_error(std::format("Node '{}' cannot read itself", name)));
+        }
+
+        graph_node *input = find_node(variable);
+        if (!input)
+        {
+            continue;
+        }
+
+        for (const graph_node *reader : readers)
+        {
+            if (reaches(reader, input))
+            {
+                FLUXINS_THROW(std::logic_error(std::format("Node '{}' cannot read node '{}', which reads node '{}'", name, variable, name)));
+            }
+        }
+
+        inputs.emplace_back(input);
+    }
+
+    graph_node *node = existing;
+    if (!node)
+    {
+        node       = &nodes[name];
+        node->name = name;
+
+        if (!ctx->variables.contains(name))
+        {
+            ctx->set_variable(name, 0.0f);
+        }
+        node->slot = &ctx->variables.at(name);
+
+        // Readers bound to the variable of a parent context read the node now
+        node->outputs = readers;
+        for (graph_node *reader : readers)
+        {
+            reader->inputs.emplace_back(node);
+            reader->expr.bind();
+        }
+    }
+
+    for (graph_node *input : node->inputs)
+    {
+        unlink(input->outputs, node);
+    }
+
+    node->inputs = std::move(inputs);
+    for (graph_node *input : node->inputs)
+    {
+        input->outputs.emplace_back(node);
+    }
+
+    node->expr    = std::move(prepared);
+    node->symbols = std::move(symbols);
+    node->expr.bind();
+
+    update_levels(*node);
+    levels_outdated = true;
+    return *node;
+}
+
+void fluxins::expression_graph::remove_node(const std::string &name)
+{
+    auto it = nodes.find(name);
+    if (it == nodes.end())
+    {
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find node '{}'", name)));
+    }
+
+    graph_node &node = it->second;
+
+    for (graph_node *input : node.inputs)
+    {
+        unlink(input->outputs, &node);
+    }
+
+    std::vector<graph_node *> readers = std::move(node.outputs);
+    for (graph_node *reader : readers)
+    {
+        unlink(reader->inputs, &node);
+    }
+
+    // Handles to the variable are stale now
+    ctx->variables.erase(name);
+    nodes.erase(it);
+
+    for (graph_node *reader : readers)
+    {
+        reader->expr.bind();
+        update_levels(*reader);
+    }
+    levels_outdated = true;
+}
+
+fluxins::graph_node *fluxins::expression_graph::find_node(const std::string &name)
+{
+    auto it = nodes.find(name);
+    return it != nodes.end() ? &it->second : nullptr;
+}
+
+float fluxins::expression_graph::get_value(const std::string &name) const
+{
+    auto it = nodes.find(name);
+    if (it == nodes.end())
+    {
+        FLUXINS_THROW(std::invalid_argument(std::format("Cannot find node '{}'", name)));
+    }
+
+    return it->second.expr.value;
+}
+
+fluxins::expression_graph &fluxins::expression_graph::set_input(const std::string &name, const fluxins_variable &variable)
+{
+    if (nodes.contains(name))
+    {
+        FLUXINS_THROW(std::logic_error(std::format("Node '{}' cannot be set as an input", name)));
+    }
+
+    ctx->set_variable(name, variable);
+    return *this;
+}
+
+std::size_t fluxins::expression_graph::evaluate(thread_pool &pool)
+{
+    if (levels_outdated)
+    {
+        levels.clear();
+        for (auto &[name, node] : nodes)
+        {
+            if (node.level >= levels.size())
+            {
+                levels.resize(node.level + 1);
+            }
+            levels[node.level].emplace_back(&node);
+        }
+        levels_outdated = false;
+    }
+
+    std::size_t               evaluated = 0;
+    std::vector<graph_node *> pending;
+
+    auto evaluate_node = [](graph_node &node) {
+        node.expr.evaluate();
+        *node.slot = node.expr.value;
+    };
+
+    for (const auto &level : levels)
+    {
+        // Nodes whose inputs did not change are skipped
+        pending.clear();
+        std::copy_if(level.begin(), level.end(), std::back_inserter(pending), [](const graph_node *node) { return node->expr.outdated(); });
+
+        if (pending.size() == 1)
+        {
+            evaluate_node(*pending.front());
+        }
+        else
+        {
+            pool.parallel_for(pending.size(), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    evaluate_node(*pending[i]);
+                }
+            });
+        }
+
+        evaluated += pending.size();
+    }
+
+    return evaluated;
+}
@@ -0,0 +1,190 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for bytecode interpreter.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+
+float fluxins::report_stale_program(const code &expr)
+{
+    // Whole code is the location, operators are not known by their index anymore
+    return report_error({ .message = "Config was modified after the bytecode was compiled", .location = { 0, expr.expr.size(), 0 } }, expr);
+}
+
+float fluxins::execute(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    // Most expressions fit in a small stack, avoid allocating for them
+    std::array<float, 32> small_stack;
+    std::vector<float>    large_stack;
+
+    // Locals are stored after the stack
+    float *stack = small_stack.data();
+    if (program.max_stack + program.locals > small_stack.size())
+    {
+        large_stack.resize(program.max_stack + program.locals);
+        stack = large_stack.data();
+    }
+
+    std::vector<float> args;
+
+    const fluxins_variable *const *variables = program.variables.empty() ? nullptr : program.variables.data();
+    return execute(program, expr, *cfg, ctx.get(), variables, stack, args);
+}
+
+float fluxins::execute(
+    const bytecode                &program,
+    const code                    &expr,
+    const config                  &cfg,
+    const context                 *ctx,
+    const fluxins_variable *const *variables,
+    float                         *stack,
+    std::vector<float>            &args)
+{
+    // Operands of the operators are indices into the lists of operators of the
+    // config, which are only valid for the same version
+    if (program.version != cfg.version)
+    {
+        return report_stale_program(expr);
+    }
+
+    std::size_t sp   = 0; // Stack pointer (number of values on stack)
+    std::size_t pc   = 0; // Program counter
+    std::size_t size = program.instructions.size();
+
+    while (pc < size)
+    {
+        const instruction &inst = program.instructions[pc];
+
+        switch (inst.op)
+        {
+            case opcode::push_number:
+                stack[sp++] = std::bit_cast<float>(inst.operand);
+                break;
+
+            case opcode::load_variable:
+            {
+                if (variables && variables[inst.operand])
+                {
+                    stack[sp++] = *variables[inst.operand];
+                    break;
+                }
+
+                const std::string &name = program.names[inst.operand];
+                if (auto resolved = ctx ? ctx->resolve_variable(name) : std::nullopt)
+                {
+                    stack[sp++] = *resolved;
+                    break;
+                }
+
+                stack[sp++] = report_error(error_info::unresolved(name, "variable", program.locations[pc]), expr);
+                break;
+            }
+
+            case opcode::call_function:
+            {
+                const fluxins_function *function = nullptr;
+
+                if (!program.functions.empty() && program.functions[inst.operand])
+                {
+                    function = program.functions[inst.operand];
+                }
+                else if (ctx)
+                {
+                    function = ctx->bind_function(program.names[inst.operand]);
+                }
+
+                sp -= inst.count;
+
+                if (!function || !*function)
+                {
+                    stack[sp++] = report_error(error_info::unresolved(program.names[inst.operand], "function", program.locations[pc]), expr);
+                    break;
+                }
+
+                args.assign(stack + sp, stack + sp + inst.count);
+                stack[sp++] = (*function)(expr, program.locations[pc], args);
+                break;
+            }
+
+            case opcode::unary_prefix:
+            {
+                const auto &op_info = cfg.unary_prefix_operators[inst.operand];
+                stack[sp - 1]       = op_info.operate(expr, program.locations[pc], stack[sp - 1]);
+                break;
+            }
+
+            case opcode::unary_suffix:
+            {
+                const auto &op_info = cfg.unary_suffix_operators[inst.operand];
+                stack[sp - 1]       = op_info.operate(expr, program.locations[pc], stack[sp - 1]);
+                break;
+            }
+
+            case opcode::binary:
+            {
+                const auto &op_info = cfg.binary_operators[inst.operand];
+                sp--;
+                stack[sp - 1] = op_info.operate(expr, program.locations[pc], stack[sp - 1], stack[sp]);
+                break;
+            }
+
+            case opcode::jump:
+                pc = inst.operand;
+                continue;
+
+            case opcode::jump_if_zero:
+                if (stack[--sp] == 0.0f)
+                {
+                    pc = inst.operand;
+                    continue;
+                }
+                break;
+
+            case opcode::store_local:
+                stack[program.max_stack + inst.operand] = stack[sp - 1];
+                break;
+
+            case opcode::load_local:
+                stack[sp++] = stack[program.max_stack + inst.operand];
+                break;
+
+            default:
+                // Possibly unreachable code
+                return report_error({ .message = "Invalid instruction", .location = program.locations[pc] }, expr);
+        }
+
+        pc++;
+    }
+
+    return stack[0];
+}
+
+std::expected<float, fluxins::error_info> fluxins::try_execute(
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    return collect_errors([&] { return execute(program, expr, cfg, ctx); });
+}
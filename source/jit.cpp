@@ -0,0 +1,702 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for native compilation of
+/// bytecode into x86-64 machine code.
+///
+/// Native code keeps the values in a stack in memory, just like the
+/// interpreter. Since the stack depth of each instruction is known at compile
+/// time, every stack slot is addressed directly relative to the stack base.
+///
+/// Register usage: `rbx` holds the stack base, `r12` holds the `jit_state`,
+/// `xmm0`-`xmm2` are scratch registers.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "fluxins/bytecode.hpp"
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/jit.hpp"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(_WIN32)
+#define FLUXINS_JIT_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/// State shared between the native code and the library calls it makes.
+struct jit_state {
+    /// Bound variable for each name (if the program is bound), read directly
+    /// by the native code (which relies on it being the first member).
+    fluxins::fluxins_variable *const *variables = nullptr;
+
+    const fluxins::bytecode *program = nullptr;
+    const fluxins::code     *expr    = nullptr;
+    const fluxins::config   *cfg     = nullptr;
+    const fluxins::context  *ctx     = nullptr;
+    float                   *stack   = nullptr;
+
+    std::vector<float> args;  ///< Reused storage for function arguments.
+    std::exception_ptr error; ///< Exception thrown by a library call.
+};
+
+/// Signature of the native code entry point.
+/// @return Non-zero when an exception was thrown.
+using jit_entry = int (*)(jit_state *state, float *stack);
+
+// Library calls made from native code
+
+/// Execute a single instruction that was not lowered into native
+/// instructions. `sp` is the stack depth before executing the instruction.
+static void jit_execute_step(jit_state *state, std::uint32_t pc, std::uint32_t sp)
+{
+    const fluxins::bytecode      &program  = *state->program;
+    const fluxins::instruction   &inst     = program.instructions[pc];
+    const fluxins::code_location &location = program.locations[pc];
+    const fluxins::code          &expr     = *state->expr;
+    float                        *stack    = state->stack;
+
+    switch (inst.op)
+    {
+        case fluxins::opcode::load_variable:
+        {
+            if (state->variables && state->variables[inst.operand])
+            {
+                stack[sp] = *state->variables[inst.operand];
+                break;
+            }
+
+            const std::string &name = program.names[inst.operand];
+            if (auto resolved = state->ctx ? state->ctx->resolve_variable(name) : std::nullopt)
+            {
+                stack[sp] = *resolved;
+                break;
+            }
+
+            stack[sp] = fluxins::report_error(fluxins::error_info::unresolved(name, "variable", location), expr);
+            break;
+        }
+
+        case fluxins::opcode::call_function:
+        {
+            const fluxins::fluxins_function *function = nullptr;
+
+            if (!program.functions.empty() && program.functions[inst.operand])
+            {
+                function = program.functions[inst.operand];
+            }
+            else if (state->ctx)
+            {
+                function = state->ctx->bind_function(program.names[inst.operand]);
+            }
+
+            if (!function || !*function)
+            {
+                stack[sp - inst.count] = fluxins::report_error(fluxins::error_info::unresolved(program.names[inst.operand], "function", location), expr);
+                break;
+            }
+
+            state->args.assign(stack + sp - inst.count, stack + sp);
+            stack[sp - inst.count] = (*function)(expr, location, state->args);
+            break;
+        }
+
+        case fluxins::opcode::unary_prefix:
+        {
+            const auto &op_info = state->cfg->unary_prefix_operators[inst.operand];
+            stack[sp - 1]       = op_info.operate(expr, location, stack[sp - 1]);
+            break;
+        }
+
+        case fluxins::opcode::unary_suffix:
+        {
+            const auto &op_info = state->cfg->unary_suffix_operators[inst.operand];
+            stack[sp - 1]       = op_info.operate(expr, location, stack[sp - 1]);
+            break;
+        }
+
+        case fluxins::opcode::binary:
+        {
+            const auto &op_info = state->cfg->binary_operators[inst.operand];
+            stack[sp - 2]       = op_info.operate(expr, location, stack[sp - 2], stack[sp - 1]);
+            break;
+        }
+
+        default:
+            // Possibly unreachable code
+            fluxins::report_error({ .message = "Invalid instruction", .location = location }, expr);
+            break;
+    }
+}
+
+/// Execute a single instruction from native code (see `jit_execute_step`).
+///
+/// Exceptions cannot be propagated through native code (it has no unwind
+/// information), so they are stored in the state and rethrown later.
+///
+/// @return Non-zero when an exception was thrown.
+static int jit_step(jit_state *state, std::uint32_t pc, std::uint32_t sp)
+{
+#ifndef FLUXINS_NO_EXCEPTIONS
+    try
+    {
+        jit_execute_step(state, pc, sp);
+    }
+    catch (...)
+    {
+        state->error = std::current_exception();
+        return 1;
+    }
+#else
+    jit_execute_step(state, pc, sp);
+#endif
+
+    return 0;
+}
+
+static float jit_power(float x, float y)
+{
+    return std::pow(x, y);
+}
+
+static float jit_minimum(float x, float y)
+{
+    return std::fmin(x, y);
+}
+
+static float jit_maximum(float x, float y)
+{
+    return std::fmax(x, y);
+}
+
+#ifdef FLUXINS_JIT_X86_64
+
+/// Minimal x86-64 machine code emitter for the instructions we need.
+struct assembler {
+    std::vector<std::uint8_t> code;
+
+    std::vector<std::size_t> error_fixups; ///< Jumps to the error exit.
+
+    void bytes(std::initializer_list<std::uint8_t> list)
+    {
+        code.insert(code.end(), list);
+    }
+
+    void imm32(std::uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            code.push_back((std::uint8_t) (value >> (i * 8)));
+        }
+    }
+
+    void imm64(std::uint64_t value)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            code.push_back((std::uint8_t) (value >> (i * 8)));
+        }
+    }
+
+    /// Emit a placeholder for relative jump offset.
+    /// @return Position of the placeholder for `patch()`.
+    std::size_t rel32()
+    {
+        imm32(0);
+        return code.size() - 4;
+    }
+
+    /// Point the relative jump offset at `at` to `target`.
+    void patch(std::size_t at, std::size_t target)
+    {
+        auto rel = (std::int32_t) ((std::int64_t) target - (std::int64_t) (at + 4));
+        std::memcpy(code.data() + at, &rel, sizeof(rel));
+    }
+
+    /// `movss xmm, [rbx + slot * 4]`
+    void load(int xmm, std::size_t slot)
+    {
+        bytes({ 0xF3, 0x0F, 0x10, (std::uint8_t) (0x83 | xmm << 3) });
+        imm32((std::uint32_t) (slot * sizeof(float)));
+    }
+
+    /// `movss [rbx + slot * 4], xmm`
+    void store(int xmm, std::size_t slot)
+    {
+        bytes({ 0xF3, 0x0F, 0x11, (std::uint8_t) (0x83 | xmm << 3) });
+        imm32((std::uint32_t) (slot * sizeof(float)));
+    }
+
+    /// `mov dword [rbx + slot * 4], value`
+    void store_constant(std::size_t slot, float value)
+    {
+        bytes({ 0xC7, 0x83 });
+        imm32((std::uint32_t) (slot * sizeof(float)));
+        imm32(std::bit_cast<std::uint32_t>(value));
+    }
+
+    /// Scalar single-precision SSE operation `op xmm_dst, xmm_src`.
+    void scalar(std::uint8_t op, int dst, int src)
+    {
+        bytes({ 0xF3, 0x0F, op, (std::uint8_t) (0xC0 | dst << 3 | src) });
+    }
+
+    /// Packed single-precision SSE operation `op xmm_dst, xmm_src`.
+    void packed(std::uint8_t op, int dst, int src)
+    {
+        bytes({ 0x0F, op, (std::uint8_t) (0xC0 | dst << 3 | src) });
+    }
+
+    /// `cmpss xmm_dst, xmm_src, predicate`
+    void compare(int dst, int src, std::uint8_t predicate)
+    {
+        bytes({ 0xF3, 0x0F, 0xC2, (std::uint8_t) (0xC0 | dst << 3 | src), predicate });
+    }
+
+    /// `xmm = value` (through `eax`).
+    void constant(int xmm, float value)
+    {
+        bytes({ 0xB8 });
+        imm32(std::bit_cast<std::uint32_t>(value));
+        bytes({ 0x66, 0x0F, 0x6E, (std::uint8_t) (0xC0 | xmm << 3) });
+    }
+
+    /// `xmm0 = (xmm0 mask) ? 1.0f : 0.0f`
+    void mask_to_one()
+    {
+        constant(2, 1.0f);
+        packed(0x54, 0, 2); // andps
+    }
+
+    /// `call function` (absolute address through `rax`).
+    void call(const void *function)
+    {
+        bytes({ 0x48, 0xB8 });
+        imm64((std::uint64_t) (std::uintptr_t) function);
+        bytes({ 0xFF, 0xD0 });
+    }
+
+    /// Call `jit_step` for the instruction, exit on error.
+    void step(std::size_t pc, std::size_t depth)
+    {
+        bytes({ 0x4C, 0x89, 0xE7 }); // mov rdi, r12
+        bytes({ 0xBE });             // mov esi, pc
+        imm32((std::uint32_t) pc);
+        bytes({ 0xBA });             // mov edx, depth
+        imm32((std::uint32_t) depth);
+        call(std::bit_cast<const void *>(&jit_step));
+        bytes({ 0x85, 0xC0 });       // test eax, eax
+        bytes({ 0x0F, 0x85 });       // jnz error
+        error_fixups.emplace_back(rel32());
+    }
+
+    /// Emit `slot = variables[name]` reading the bound variable, calls
+    /// `jit_step` when the variable is not bound.
+    void load_variable(std::size_t pc, std::size_t depth, std::uint32_t name)
+    {
+        bytes({ 0x49, 0x8B, 0x04, 0x24 }); // mov rax, [r12]
+        bytes({ 0x48, 0x85, 0xC0 });       // test rax, rax
+        bytes({ 0x0F, 0x84 });             // jz unbound
+        std::size_t unbound_program = rel32();
+        bytes({ 0x48, 0x8B, 0x80 });       // mov rax, [rax + name * 8]
+        imm32(name * (std::uint32_t) sizeof(void *));
+        bytes({ 0x48, 0x85, 0xC0 });       // test rax, rax
+        bytes({ 0x0F, 0x84 });             // jz unbound
+        std::size_t unbound_variable = rel32();
+
+        bytes({ 0xF3, 0x0F, 0x10, 0x00 }); // movss xmm0, [rax]
+        store(0, depth);
+        bytes({ 0xE9 }); // jmp done
+        std::size_t done = rel32();
+
+        patch(unbound_program, code.size());
+        patch(unbound_variable, code.size());
+        step(pc, depth);
+
+        patch(done, code.size());
+    }
+
+    /// Emit `xmm0 = xmm0 <op> xmm1` for an intrinsic that cannot throw.
+    /// @return False when the intrinsic is not supported.
+    bool operate(fluxins::intrinsic builtin)
+    {
+        using fluxins::intrinsic;
+
+        switch (builtin)
+        {
+            case intrinsic::add:      scalar(0x58, 0, 1); return true;
+            case intrinsic::subtract: scalar(0x5C, 0, 1); return true;
+            case intrinsic::multiply: scalar(0x59, 0, 1); return true;
+
+            // Same functions as the built-in operators, keeps the results identical
+            case intrinsic::power:   call(std::bit_cast<const void *>(&jit_power)); return true;
+            case intrinsic::minimum: call(std::bit_cast<const void *>(&jit_minimum)); return true;
+            case intrinsic::maximum: call(std::bit_cast<const void *>(&jit_maximum)); return true;
+
+            // Comparison yields all-ones mask when true, which is then masked to 1.0f
+            case intrinsic::equal:      compare(0, 1, 0); mask_to_one(); return true;
+            case intrinsic::less:       compare(0, 1, 1); mask_to_one(); return true;
+            case intrinsic::less_equal: compare(0, 1, 2); mask_to_one(); return true;
+            case intrinsic::not_equal:  compare(0, 1, 4); mask_to_one(); return true;
+
+            // Swapped operands of less, NaN compares as false
+            case intrinsic::greater:
+                compare(1, 0, 1);
+                packed(0x28, 0, 1); // movaps
+                mask_to_one();
+                return true;
+            case intrinsic::greater_equal:
+                compare(1, 0, 2);
+                packed(0x28, 0, 1); // movaps
+                mask_to_one();
+                return true;
+
+            case intrinsic::logical_and:
+            case intrinsic::logical_or:
+                packed(0x57, 2, 2); // xorps
+                compare(0, 2, 4);
+                compare(1, 2, 4);
+                packed(builtin == intrinsic::logical_and ? 0x54 : 0x56, 0, 1); // andps/orps
+                mask_to_one();
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    /// Emit `slot = xmm0 / xmm1`, calls into the operator on division by zero
+    /// (which throws).
+    void divide(std::size_t pc, std::size_t depth, std::size_t slot)
+    {
+        packed(0x57, 2, 2);          // xorps xmm2, xmm2
+        bytes({ 0x0F, 0x2E, 0xCA }); // ucomiss xmm1, xmm2
+        bytes({ 0x0F, 0x8A });       // jp fast (NaN is not zero)
+        std::size_t unordered = rel32();
+        bytes({ 0x0F, 0x85 }); // jne fast
+        std::size_t not_zero = rel32();
+
+        step(pc, depth);
+        bytes({ 0xE9 }); // jmp done
+        std::size_t done = rel32();
+
+        patch(unordered, code.size());
+        patch(not_zero, code.size());
+        scalar(0x5E, 0, 1); // divss
+        store(0, slot);
+
+        patch(done, code.size());
+    }
+
+    /// Emit an operator with operands `x` and `y` in `xmm0` and `xmm1`, and
+    /// result stored in `slot`.
+    void operator_call(fluxins::intrinsic builtin, std::size_t pc, std::size_t depth, std::size_t slot)
+    {
+        if (builtin == fluxins::intrinsic::divide)
+        {
+            divide(pc, depth, slot);
+        }
+        else if (operate(builtin))
+        {
+            store(0, slot);
+        }
+        else
+        {
+            // Possibly unreachable code
+            // Callers check if the intrinsic is supported
+            step(pc, depth);
+        }
+    }
+};
+
+/// Returns true when the intrinsic can be lowered into native instructions.
+static bool jit_lowerable(fluxins::intrinsic builtin)
+{
+    return builtin != fluxins::intrinsic::none && builtin != fluxins::intrinsic::max;
+}
+
+/// Returns true when the intrinsic can be lowered for unary operator (it has
+/// an implicit left operand).
+static bool jit_lowerable_unary(fluxins::intrinsic builtin)
+{
+    using fluxins::intrinsic;
+    return builtin == intrinsic::add ||
+           builtin == intrinsic::subtract ||
+           builtin == intrinsic::multiply ||
+           builtin == intrinsic::divide ||
+           builtin == intrinsic::equal;
+}
+
+/// Implicit left operand for unary operators.
+static float jit_unary_identity(fluxins::intrinsic builtin)
+{
+    return builtin == fluxins::intrinsic::multiply || builtin == fluxins::intrinsic::divide ? 1.0f : 0.0f;
+}
+
+#endif
+
+// Implementation
+
+fluxins::native_code::~native_code()
+{
+#ifdef FLUXINS_JIT_X86_64
+    if (memory)
+    {
+        munmap(memory, size);
+    }
+#endif
+}
+
+bool fluxins::jit_supported()
+{
+#ifdef FLUXINS_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::shared_ptr<fluxins::native_code> fluxins::jit_compile(
+    const bytecode         &program,
+    std::shared_ptr<config> cfg)
+{
+#ifdef FLUXINS_JIT_X86_64
+    assembler emitter;
+
+    std::size_t size = program.instructions.size();
+
+    std::vector<std::size_t> offsets(size + 1);                // Native offset of each instruction
+    std::vector<std::size_t> depths(size + 1, (std::size_t) -1); // Stack depth at jump targets
+    std::vector<std::pair<std::size_t, std::size_t>> jumps;      // Placeholder and target instruction
+
+    // Prologue: keeps the stack 16-byte aligned for calls
+    emitter.bytes({ 0x53 });                   // push rbx
+    emitter.bytes({ 0x41, 0x54 });             // push r12
+    emitter.bytes({ 0x48, 0x83, 0xEC, 0x08 }); // sub rsp, 8
+    emitter.bytes({ 0x48, 0x89, 0xF3 });       // mov rbx, rsi
+    emitter.bytes({ 0x49, 0x89, 0xFC });       // mov r12, rdi
+
+    std::size_t depth = 0;
+    for (std::size_t pc = 0; pc < size; pc++)
+    {
+        const instruction &inst = program.instructions[pc];
+
+        // Instruction after an unconditional jump is only reachable by jumps
+        if (depths[pc] != (std::size_t) -1)
+        {
+            depth = depths[pc];
+        }
+
+        offsets[pc] = emitter.code.size();
+
+        switch (inst.op)
+        {
+            case opcode::push_number:
+                emitter.store_constant(depth, std::bit_cast<float>(inst.operand));
+                depth++;
+                break;
+
+            case opcode::load_variable:
+                emitter.load_variable(pc, depth, inst.operand);
+                depth++;
+                break;
+
+            case opcode::call_function:
+                emitter.step(pc, depth);
+                depth = depth - inst.count + 1;
+                break;
+
+            case opcode::unary_prefix:
+            case opcode::unary_suffix:
+            {
+                const auto &op_info = inst.op == opcode::unary_prefix
+                                        ? cfg->unary_prefix_operators[inst.operand]
+                                        : cfg->unary_suffix_operators[inst.operand];
+
+                if (!jit_lowerable_unary(op_info.builtin))
+                {
+                    emitter.step(pc, depth);
+                    break;
+                }
+
+                emitter.constant(0, jit_unary_identity(op_info.builtin));
+                emitter.load(1, depth - 1);
+                emitter.operator_call(op_info.builtin, pc, depth, depth - 1);
+                break;
+            }
+
+            case opcode::binary:
+            {
+                const auto &op_info = cfg->binary_operators[inst.operand];
+
+                if (!jit_lowerable(op_info.builtin))
+                {
+                    emitter.step(pc, depth);
+                }
+                else
+                {
+                    emitter.load(0, depth - 2);
+                    emitter.load(1, depth - 1);
+                    emitter.operator_call(op_info.builtin, pc, depth, depth - 2);
+                }
+
+                depth--;
+                break;
+            }
+
+            case opcode::jump:
+                emitter.bytes({ 0xE9 });
+                jumps.emplace_back(emitter.rel32(), inst.operand);
+                depths[inst.operand] = depth;
+                break;
+
+            case opcode::jump_if_zero:
+                depth--;
+                emitter.load(0, depth);
+                emitter.packed(0x57, 1, 1);           // xorps xmm1, xmm1
+                emitter.bytes({ 0x0F, 0x2E, 0xC1 });  // ucomiss xmm0, xmm1
+                emitter.bytes({ 0x7A, 0x06 });        // jp +6 (NaN is not zero)
+                emitter.bytes({ 0x0F, 0x84 });        // je target
+                jumps.emplace_back(emitter.rel32(), inst.operand);
+                depths[inst.operand] = depth;
+                break;
+
+            case opcode::store_local:
+                emitter.load(0, depth - 1);
+                emitter.store(0, program.max_stack + inst.operand);
+                break;
+
+            case opcode::load_local:
+                emitter.load(0, program.max_stack + inst.operand);
+                emitter.store(0, depth);
+                depth++;
+                break;
+
+            default:
+                // Possibly unreachable code
+                return nullptr;
+        }
+    }
+
+    offsets[size] = emitter.code.size();
+
+    // Success exit
+    emitter.bytes({ 0x31, 0xC0 }); // xor eax, eax
+
+    std::size_t epilogue = emitter.code.size();
+    emitter.bytes({ 0x48, 0x83, 0xC4, 0x08 }); // add rsp, 8
+    emitter.bytes({ 0x41, 0x5C });             // pop r12
+    emitter.bytes({ 0x5B });                   // pop rbx
+    emitter.bytes({ 0xC3 });                   // ret
+
+    // Error exit
+    std::size_t error = emitter.code.size();
+    emitter.bytes({ 0xB8, 0x01, 0x00, 0x00, 0x00 }); // mov eax, 1
+    emitter.bytes({ 0xE9 });                         // jmp epilogue
+    emitter.patch(emitter.rel32(), epilogue);
+
+    for (auto [at, target] : jumps)
+    {
+        emitter.patch(at, offsets[target]);
+    }
+
+    for (std::size_t at : emitter.error_fixups)
+    {
+        emitter.patch(at, error);
+    }
+
+    // Copy into writable pages, then make them executable (but not writable)
+    std::size_t page_size = (std::size_t) sysconf(_SC_PAGESIZE);
+    std::size_t capacity  = (emitter.code.size() + page_size - 1) / page_size * page_size;
+
+    void *memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    std::memcpy(memory, emitter.code.data(), emitter.code.size());
+
+    if (mprotect(memory, capacity, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(memory, capacity);
+        return nullptr;
+    }
+
+    auto native     = std::make_shared<native_code>();
+    native->memory  = memory;
+    native->size    = capacity;
+    native->version = cfg->version;
+    return native;
+#else
+    return nullptr;
+#endif
+}
+
+float fluxins::jit_execute(
+    const native_code       &native,
+    const bytecode          &program,
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    if (!native.memory)
+    {
+        return execute(program, expr, cfg, ctx);
+    }
+
+    // Operators that are not lowered are called by their index in the lists
+    // of operators of the config, which is only valid for the same version
+    if (native.version != cfg->version || program.version != cfg->version)
+    {
+        return report_stale_program(expr);
+    }
+
+    // Most expressions fit in a small stack, avoid allocating for them
+    std::array<float, 32> small_stack;
+    std::vector<float>    large_stack;
+
+    // Locals are stored after the stack
+    float *stack = small_stack.data();
+    if (program.max_stack + program.locals > small_stack.size())
+    {
+        large_stack.resize(program.max_stack + program.locals);
+        stack = large_stack.data();
+    }
+
+    jit_state state = {
+        .variables = program.variables.empty() ? nullptr : program.variables.data(),
+        .program   = &program,
+        .expr      = &expr,
+        .cfg       = cfg.get(),
+        .ctx       = ctx.get(),
+        .stack     = stack,
+    };
+
+    auto entry = std::bit_cast<jit_entry>(native.memory);
+    if (entry(&state, stack) != 0)
+    {
+#ifndef FLUXINS_NO_EXCEPTIONS
+        std::rethrow_exception(state.error);
+#endif
+    }
+
+    return stack[0];
+}
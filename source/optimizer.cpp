@@ -0,0 +1,461 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for optimization passes over AST.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "fluxins/code.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/optimizer.hpp"
+#include "fluxins/parser.hpp"
+
+/// Fold the child node and replace it with the folded node (if any).
+static void fold_child(
+    std::shared_ptr<fluxins::ast_node> &child,
+    const fluxins::code                &expr,
+    std::shared_ptr<fluxins::config>    cfg,
+    std::shared_ptr<fluxins::context>   ctx)
+{
+    if (auto folded = child->fold(expr, cfg, ctx))
+    {
+        child = folded;
+    }
+}
+
+/// Subexpressions seen by common subexpression elimination, by structural
+/// hash.
+using subexpression_table = std::unordered_multimap<std::size_t, std::shared_ptr<fluxins::ast_node>>;
+
+/// Mix the value into the hash.
+static std::size_t hash_combine(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2));
+}
+
+/// Shared nodes are transparent for comparison.
+static const fluxins::ast_node &unwrap(const fluxins::ast_node &node)
+{
+    if (auto shared = dynamic_cast<const fluxins::shared_ast *>(&node))
+    {
+        return unwrap(*shared->node);
+    }
+    return node;
+}
+
+/// Get the children of the node.
+static std::vector<std::shared_ptr<fluxins::ast_node> *> children_of(fluxins::ast_node &node)
+{
+    std::vector<std::shared_ptr<fluxins::ast_node> *> children;
+
+    if (auto function = dynamic_cast<fluxins::function_ast *>(&node))
+    {
+        for (auto &arg : function->args)
+        {
+            children.emplace_back(&arg);
+        }
+    }
+    else if (auto op = dynamic_cast<fluxins::operator_ast *>(&node))
+    {
+        if (op->left) children.emplace_back(&op->left);
+        if (op->right) children.emplace_back(&op->right);
+    }
+    else if (auto conditional = dynamic_cast<fluxins::conditional_ast *>(&node))
+    {
+        children.emplace_back(&conditional->condition);
+        children.emplace_back(&conditional->true_value);
+        children.emplace_back(&conditional->false_value);
+    }
+    else if (auto shared = dynamic_cast<fluxins::shared_ast *>(&node))
+    {
+        children.emplace_back(&shared->node);
+    }
+
+    return children;
+}
+
+/// Replace the node with an equal node seen before (if any), after doing the
+/// same for its children.
+/// @return False when the node cannot be shared (calls impure functions).
+static bool merge_subexpressions(
+    std::shared_ptr<fluxins::ast_node> &node,
+    subexpression_table                &seen,
+    const fluxins::context             *ctx)
+{
+    // Shared by a previous pass, share again from scratch
+    if (auto shared = std::dynamic_pointer_cast<fluxins::shared_ast>(node))
+    {
+        node = shared->node;
+    }
+
+    // Impure functions may not return the same value each call
+    bool shareable = true;
+    if (auto function = std::dynamic_pointer_cast<fluxins::function_ast>(node))
+    {
+        shareable = ctx && ctx->resolve_function_traits(function->name).pure;
+    }
+
+    auto children = children_of(*node);
+    for (auto *child : children)
+    {
+        shareable = merge_subexpressions(*child, seen, ctx) && shareable;
+    }
+
+    // Leaves are as cheap as loading a shared value
+    if (!shareable || children.empty())
+    {
+        return shareable;
+    }
+
+    std::size_t hash   = node->hash();
+    auto [first, last] = seen.equal_range(hash);
+    for (auto it = first; it != last; it++)
+    {
+        if (it->second->equals(*node))
+        {
+            node = it->second;
+            return true;
+        }
+    }
+
+    seen.emplace(hash, node);
+    return true;
+}
+
+/// Replace the node with a number when it is a variable with a constant value,
+/// or do the same for its children.
+static void substitute_node(std::shared_ptr<fluxins::ast_node> &node, const fluxins::fluxins_variables &constants)
+{
+    auto variable = std::dynamic_pointer_cast<fluxins::variable_ast>(node);
+    if (!variable)
+    {
+        for (auto *child : children_of(*node))
+        {
+            substitute_node(*child, constants);
+        }
+        return;
+    }
+
+    if (auto found = constants.find(variable->name); found != constants.end())
+    {
+        auto number      = std::make_shared<fluxins::number_ast>();
+        number->value    = found->second;
+        number->location = variable->location;
+        node             = number;
+    }
+}
+
+/// Count the number of parents of each node.
+static void count_parents(
+    const std::shared_ptr<fluxins::ast_node>                   &node,
+    std::unordered_map<const fluxins::ast_node *, std::size_t> &parents)
+{
+    // Children of a shared node are counted once
+    if (parents[node.get()]++ != 0)
+    {
+        return;
+    }
+
+    for (auto *child : children_of(*node))
+    {
+        count_parents(*child, parents);
+    }
+}
+
+/// Wrap the nodes with multiple parents into shared nodes.
+static void wrap_shared(
+    std::shared_ptr<fluxins::ast_node>                                                  &node,
+    const std::unordered_map<const fluxins::ast_node *, std::size_t>                    &parents,
+    std::unordered_map<const fluxins::ast_node *, std::shared_ptr<fluxins::shared_ast>> &wrapped)
+{
+    if (auto found = wrapped.find(node.get()); found != wrapped.end())
+    {
+        node = found->second;
+        return;
+    }
+
+    for (auto *child : children_of(*node))
+    {
+        wrap_shared(*child, parents, wrapped);
+    }
+
+    if (parents.at(node.get()) > 1)
+    {
+        auto shared      = std::make_shared<fluxins::shared_ast>();
+        shared->node     = node;
+        shared->slot     = (std::uint32_t) wrapped.size();
+        shared->location = node->location;
+        wrapped.emplace(node.get(), shared);
+        node = shared;
+    }
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::number_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    return nullptr;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::variable_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    return nullptr;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::function_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    bool constant = true;
+    for (auto &arg : args)
+    {
+        fold_child(arg, expr, cfg, ctx);
+        constant = constant && std::dynamic_pointer_cast<number_ast>(arg);
+    }
+
+    // Only pure functions return the same value when evaluated later
+    if (!constant || !ctx || !ctx->bind_function(name))
+    {
+        return nullptr;
+    }
+
+    function_traits traits = ctx->resolve_function_traits(name);
+    if (!traits.pure || !traits.accepts(args.size()))
+    {
+        return nullptr;
+    }
+
+    auto number      = std::make_shared<number_ast>();
+    number->location = location;
+
+    auto value = collect_errors([&] { return evaluate(evaluation_frame { expr, *cfg, ctx.get() }); });
+    if (!value)
+    {
+        // Leave it for the evaluation to report
+        return nullptr;
+    }
+    number->value = *value;
+
+    return number;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::operator_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    if (left) fold_child(left, expr, cfg, ctx);
+    if (right) fold_child(right, expr, cfg, ctx);
+
+    bool constant_left  = !left || std::dynamic_pointer_cast<number_ast>(left);
+    bool constant_right = !right || std::dynamic_pointer_cast<number_ast>(right);
+    if (!constant_left || !constant_right)
+    {
+        return nullptr;
+    }
+
+    auto number      = std::make_shared<number_ast>();
+    number->location = location;
+
+    // Operands are numbers, no context is needed
+    auto value = collect_errors([&] { return evaluate(evaluation_frame { expr, *cfg }); });
+    if (!value)
+    {
+        // Leave it for the evaluation to report
+        return nullptr;
+    }
+    number->value = *value;
+
+    return number;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::conditional_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    fold_child(condition, expr, cfg, ctx);
+
+    if (auto constant = std::dynamic_pointer_cast<number_ast>(condition))
+    {
+        // Only the taken branch remains
+        auto branch = constant->value != 0.0f ? true_value : false_value;
+        if (auto folded = branch->fold(expr, cfg, ctx))
+        {
+            return folded;
+        }
+        return branch;
+    }
+
+    fold_child(true_value, expr, cfg, ctx);
+    fold_child(false_value, expr, cfg, ctx);
+    return nullptr;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::shared_ast::fold(
+    const code              &expr,
+    std::shared_ptr<config>  cfg,
+    std::shared_ptr<context> ctx)
+{
+    fold_child(node, expr, cfg, ctx);
+
+    if (std::dynamic_pointer_cast<number_ast>(node))
+    {
+        return node;
+    }
+    return nullptr;
+}
+
+std::size_t fluxins::number_ast::hash() const
+{
+    return hash_combine(1, std::bit_cast<std::uint32_t>(value));
+}
+
+bool fluxins::number_ast::equals(const ast_node &other) const
+{
+    auto number = dynamic_cast<const number_ast *>(&unwrap(other));
+    return number && std::bit_cast<std::uint32_t>(number->value) == std::bit_cast<std::uint32_t>(value);
+}
+
+std::size_t fluxins::variable_ast::hash() const
+{
+    return hash_combine(2, std::hash<std::string> {}(name));
+}
+
+bool fluxins::variable_ast::equals(const ast_node &other) const
+{
+    auto variable = dynamic_cast<const variable_ast *>(&unwrap(other));
+    return variable && variable->name == name;
+}
+
+std::size_t fluxins::function_ast::hash() const
+{
+    std::size_t seed = hash_combine(3, std::hash<std::string> {}(name));
+    for (const auto &arg : args)
+    {
+        seed = hash_combine(seed, arg->hash());
+    }
+    return seed;
+}
+
+bool fluxins::function_ast::equals(const ast_node &other) const
+{
+    auto function = dynamic_cast<const function_ast *>(&unwrap(other));
+    if (!function || function->name != name || function->args.size() != args.size())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < args.size(); i++)
+    {
+        if (args[i] != function->args[i] && !args[i]->equals(*function->args[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t fluxins::operator_ast::hash() const
+{
+    // Prefix and suffix operators with the same symbol differ by the side
+    std::size_t seed = hash_combine(4, std::hash<std::string> {}(symbol));
+    seed             = hash_combine(seed, left ? left->hash() : 0);
+    seed             = hash_combine(seed, right ? right->hash() : 0);
+    return seed;
+}
+
+bool fluxins::operator_ast::equals(const ast_node &other) const
+{
+    auto op = dynamic_cast<const operator_ast *>(&unwrap(other));
+    if (!op || op->symbol != symbol || !op->left != !left || !op->right != !right)
+    {
+        return false;
+    }
+
+    return (left == op->left || !left || left->equals(*op->left)) &&
+           (right == op->right || !right || right->equals(*op->right));
+}
+
+std::size_t fluxins::conditional_ast::hash() const
+{
+    std::size_t seed = hash_combine(5, condition->hash());
+    seed             = hash_combine(seed, true_value->hash());
+    seed             = hash_combine(seed, false_value->hash());
+    return seed;
+}
+
+bool fluxins::conditional_ast::equals(const ast_node &other) const
+{
+    auto conditional = dynamic_cast<const conditional_ast *>(&unwrap(other));
+    return conditional &&
+           (condition == conditional->condition || condition->equals(*conditional->condition)) &&
+           (true_value == conditional->true_value || true_value->equals(*conditional->true_value)) &&
+           (false_value == conditional->false_value || false_value->equals(*conditional->false_value));
+}
+
+std::size_t fluxins::shared_ast::hash() const
+{
+    return node->hash();
+}
+
+bool fluxins::shared_ast::equals(const ast_node &other) const
+{
+    return node->equals(other);
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::fold_constants(
+    const code               &expr,
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<config>   cfg,
+    std::shared_ptr<context>  ctx)
+{
+    if (auto folded = ast->fold(expr, cfg, ctx))
+    {
+        return folded;
+    }
+
+    return ast;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::substitute_variables(
+    std::shared_ptr<ast_node> ast,
+    const fluxins_variables  &constants)
+{
+    substitute_node(ast, constants);
+    return ast;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::eliminate_common_subexpressions(
+    std::shared_ptr<ast_node> ast,
+    std::shared_ptr<context>  ctx)
+{
+    subexpression_table seen;
+    merge_subexpressions(ast, seen, ctx.get());
+
+    std::unordered_map<const ast_node *, std::size_t> parents;
+    count_parents(ast, parents);
+
+    std::unordered_map<const ast_node *, std::shared_ptr<shared_ast>> wrapped;
+    wrap_shared(ast, parents, wrapped);
+
+    return ast;
+}
@@ -0,0 +1,258 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for the work-stealing thread pool
+/// and evaluating many compiled expressions in parallel.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parallel.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/// True on the threads processing chunks, `parallel_for()` called from them
+/// processes the items on the same thread.
+static thread_local bool processing_chunks = false;
+
+/// Take a chunk from the front (own queue) or back (stealing) of the queue.
+/// @return True when a chunk was taken.
+static bool take_chunk(fluxins::pool_queue &queue, fluxins::pool_chunk &chunk, bool steal)
+{
+    std::lock_guard lock(queue.mutex);
+
+    if (queue.chunks.empty())
+    {
+        return false;
+    }
+
+    if (steal)
+    {
+        chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+    }
+    else
+    {
+        chunk = queue.chunks.front();
+        queue.chunks.pop_front();
+    }
+    return true;
+}
+
+/// Wait for chunks to be queued and process them until the pool is stopping.
+static void worker_loop(fluxins::thread_pool &pool, std::size_t queue)
+{
+    processing_chunks = true;
+
+    std::size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(pool.mutex);
+            pool.wake.wait(lock, [&] { return pool.stopping || pool.generation != seen; });
+            if (pool.stopping)
+            {
+                return;
+            }
+            seen = pool.generation;
+        }
+
+        pool.process(queue);
+    }
+}
+
+fluxins::thread_pool::thread_pool(const pool_options &options) : options(options)
+{
+    std::size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t threads  = options.threads ? options.threads : hardware;
+
+    for (std::size_t i = 0; i < threads; i++)
+    {
+        queues.emplace_back(std::make_unique<pool_queue>());
+    }
+
+    // The calling thread is one of the threads
+    for (std::size_t i = 0; i + 1 < threads; i++)
+    {
+        workers.emplace_back(worker_loop, std::ref(*this), i);
+
+#ifdef __linux__
+        if (options.pin_threads)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % hardware, &set);
+            pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+        }
+#endif
+    }
+}
+
+fluxins::thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void fluxins::thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)> &function)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Threads of the pool cannot wait for the pool
+    if (processing_chunks || size() == 1)
+    {
+        function(0, count);
+        return;
+    }
+
+    std::lock_guard run(running);
+
+    std::size_t chunk_size = options.chunk_size ? options.chunk_size : std::max<std::size_t>(count / (size() * 4), 1);
+    std::size_t chunks     = (count + chunk_size - 1) / chunk_size;
+
+    // Set before queueing, threads still looking for chunks of the previous
+    // call can take the chunks right away
+    {
+        std::lock_guard lock(mutex);
+        remaining = chunks;
+        error     = nullptr;
+    }
+
+    // Each thread gets consecutive chunks, stolen from the end
+    for (std::size_t i = 0; i < chunks; i++)
+    {
+        pool_queue &queue = *queues[i * size() / chunks];
+
+        std::lock_guard lock(queue.mutex);
+        queue.chunks.emplace_back(pool_chunk {
+            .function = &function,
+            .begin    = i * chunk_size,
+            .end      = std::min((i + 1) * chunk_size, count),
+        });
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        generation++;
+    }
+    wake.notify_all();
+
+    processing_chunks = true;
+    process(size() - 1);
+    processing_chunks = false;
+
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [&] { return remaining == 0; });
+
+#ifndef FLUXINS_NO_EXCEPTIONS
+    if (error)
+    {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+#endif
+}
+
+void fluxins::thread_pool::process(std::size_t queue)
+{
+    while (true)
+    {
+        pool_chunk chunk;
+
+        bool taken = take_chunk(*queues[queue], chunk, false);
+        for (std::size_t i = 1; !taken && i < size(); i++)
+        {
+            taken = take_chunk(*queues[(queue + i) % size()], chunk, true);
+        }
+
+        if (!taken)
+        {
+            return;
+        }
+
+        std::exception_ptr chunk_error;
+
+#ifndef FLUXINS_NO_EXCEPTIONS
+        try
+        {
+            (*chunk.function)(chunk.begin, chunk.end);
+        }
+        catch (...)
+        {
+            chunk_error = std::current_exception();
+        }
+#else
+        (*chunk.function)(chunk.begin, chunk.end);
+#endif
+
+        std::lock_guard lock(mutex);
+
+        // Exception of the first items is rethrown, regardless of the order
+        // the chunks are processed in
+        if (chunk_error && (!error || chunk.begin < error_begin))
+        {
+            error       = chunk_error;
+            error_begin = chunk.begin;
+        }
+
+        if (--remaining == 0)
+        {
+            finished.notify_all();
+        }
+    }
+}
+
+fluxins::thread_pool &fluxins::default_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+void fluxins::evaluate_parallel(
+    std::span<const evaluation_task> tasks,
+    std::span<float>                 output,
+    thread_pool                     &pool)
+{
+    if (output.size() < tasks.size())
+    {
+        FLUXINS_THROW(std::invalid_argument(std::format("Output has {} values, but {} tasks are evaluated", output.size(), tasks.size())));
+    }
+
+    pool.parallel_for(tasks.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const evaluation_task &task = tasks[i];
+            output[i]                   = task.compiled->evaluate(task.values, task.ctx);
+        }
+    });
+}
@@ -7,12 +7,16 @@
 ///
 /// This project is licensed under the terms of MIT License.
 
-#include <algorithm>
-#include <cctype>
+#include <array>
+#include <charconv>
 #include <cstddef>
-#include <iterator>
+#include <cstdint>
+#include <expected>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
 #include "fluxins/code.hpp"
@@ -20,156 +24,194 @@
 #include "fluxins/error.hpp"
 #include "fluxins/parser.hpp"
 
-std::vector<fluxins::token> fluxins::tokenize(const code &expr)
-{
-    std::vector<fluxins::token> tokens;
+/// Classes of a character for the tokenizer (bit flags).
+enum char_class : std::uint8_t {
+    identifier_start    = 1 << 0,
+    identifier_continue = 1 << 1,
+    number_start        = 1 << 2,
+    number_continue     = 1 << 3,
+    operator_char       = 1 << 4,
+    punctuation_char    = 1 << 5,
+    whitespace          = 1 << 6,
+    hex_digit           = 1 << 7,
+};
+
+/// Classes of every character, indexed by the character.
+static constexpr std::array<std::uint8_t, 256> char_classes = [] {
+    std::array<std::uint8_t, 256> classes = {};
+
+    auto add = [&](std::string_view chars, std::uint8_t cls) {
+        for (char c : chars)
+        {
+            classes[(unsigned char) c] |= cls;
+        }
+    };
 
-    const std::string identifier_start =
+    constexpr std::string_view letters =
         "abcdefghijklmnopqrstuvwxyz"
         "ABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+    constexpr std::string_view digits = "0123456789";
+
+    add(letters, identifier_start | identifier_continue);
+    add(digits, identifier_continue | number_start | number_continue);
+    add(".'_", number_continue);
+    add("abcdefABCDEF", hex_digit);
+    add(digits, hex_digit);
+    add("+-*/%^=!~&|<>?:[]", operator_char);
+    add("(),", punctuation_char);
+    add(" \t\n\v\f\r", whitespace);
+
+    return classes;
+}();
+
+/// Check if the character belongs to any of the classes.
+static constexpr bool is_class(char c, std::uint8_t cls)
+{
+    return (char_classes[(unsigned char) c] & cls) != 0;
+}
 
-    const std::string number_start        = "0123456789";
-    const std::string number_separator    = "'_";
-    const std::string identifier_continue = identifier_start + number_start;
-    const std::string number_continue     = number_start + ".";
+/// Check if the character is a digit separator of numbers.
+static constexpr bool is_separator(char c)
+{
+    return c == '\'' || c == '_';
+}
+
+/// Report an error from the tokenizer.
+static void report_tokenizer_error(std::string_view message, const fluxins::code &expr, fluxins::code_location location)
+{
+    fluxins::report_error({ fluxins::error_kind::tokenizer_error, std::string(message), location }, expr);
+}
 
-    const std::string operator_chars    = "+-*/%^=!~&|<>?:[]";
-    const std::string punctuation_chars = "(),";
+/// Report an unexpected token.
+/// @return nullptr, for the parser to return when the error is collected.
+static std::nullptr_t report_unexpected_token(std::string_view message, const fluxins::code &expr, const fluxins::packed_token &tok)
+{
+    fluxins::report_error(fluxins::error_info::unexpected_at(message, tok.unpack(expr)), expr);
+    return nullptr;
+}
+
+std::vector<fluxins::packed_token> fluxins::tokenize_packed(const code &expr)
+{
+    std::vector<packed_token> tokens;
+
+    const std::string_view source = expr.expr;
+
+    if (source.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        report_tokenizer_error("Expression is too long", expr, { 0, source.size(), 0 });
+        return {};
+    }
+
+    // Most of the tokens are one or two characters long
+    tokens.reserve(source.size() / 2 + 1);
 
     std::size_t index = 0;
-    while (index < expr.expr.size())
+    while (index < source.size())
     {
+        std::size_t       begin = index;
+        token::token_type type  = token::token_type::max;
+
         // Identifier
-        if (identifier_start.contains(expr.expr[index]))
+        if (is_class(source[index], identifier_start))
         {
-            std::size_t begin = index;
-
-            while (index < expr.expr.size() && identifier_continue.contains(expr.expr[index]))
+            while (index < source.size() && is_class(source[index], identifier_continue))
             {
                 index++;
             }
-
-            code_location location = {
-                .begin   = begin,
-                .length  = index - begin,
-                .pointer = 0,
-            };
-
-            std::string value = std::string(expr.expr.substr(location.begin, location.length));
-
-            tokens.emplace_back(token{
-                .type     = token::token_type::identifier,
-                .value    = value,
-                .location = location,
-            });
+            type = token::token_type::identifier;
         }
 
         // Number
-        else if (number_start.contains(expr.expr[index]))
+        else if (is_class(source[index], number_start))
         {
-            std::size_t begin                         = index;
-            bool        found_decimal_point           = false;
-            bool        found_multiple_decimal_points = false;
+            bool hexadecimal =
+                source[index] == '0' &&
+                index + 2 < source.size() &&
+                (source[index + 1] == 'x' || source[index + 1] == 'X') &&
+                is_class(source[index + 2], hex_digit);
 
-            while (index < expr.expr.size() && number_continue.contains(expr.expr[index]))
+            if (hexadecimal)
             {
-                // Must have only one '.' character
-                if (expr.expr[index] == '.')
+                index += 2; // Skip "0x"
+
+                while (index < source.size() && (is_class(source[index], hex_digit) || is_separator(source[index])))
                 {
-                    if (found_decimal_point)
-                    {
-                        found_multiple_decimal_points = true;
-                    }
-                    found_decimal_point = true;
+                    index++;
                 }
-                index++;
             }
-
-            code_location location = {
-                .begin   = begin,
-                .length  = index - begin,
-                .pointer = 0,
-            };
-
-            std::string raw = std::string(expr.expr.substr(location.begin, location.length));
-
-            for (char separator : number_separator)
+            else
             {
-                if (raw.ends_with(separator))
+                bool found_decimal_point           = false;
+                bool found_multiple_decimal_points = false;
+
+                while (index < source.size() && is_class(source[index], number_continue))
                 {
-                    throw tokenizer_error("Number cannot end with separator characters", expr, location);
+                    // Must have only one '.' character
+                    if (source[index] == '.')
+                    {
+                        if (found_decimal_point)
+                        {
+                            found_multiple_decimal_points = true;
+                        }
+                        found_decimal_point = true;
+                    }
+                    index++;
                 }
-            }
-
-            std::string value;
 
-            // clang-format off
+                if (found_multiple_decimal_points)
+                {
+                    report_tokenizer_error("Number cannot contain multiple decimal points", expr, { begin, index - begin, 0 });
+                    return {};
+                }
 
-            // Remove 
-            std::copy_if(raw.begin(), raw.end(), std::back_inserter(value),
-                [&](char c) { return !number_separator.contains(c); });
+                // Exponent is only a part of the number when followed by digits
+                if (index < source.size() && (source[index] == 'e' || source[index] == 'E'))
+                {
+                    std::size_t exponent = index + 1;
+                    if (exponent < source.size() && (source[exponent] == '+' || source[exponent] == '-'))
+                    {
+                        exponent++;
+                    }
 
-            // clang-format on
+                    if (exponent < source.size() && is_class(source[exponent], number_start))
+                    {
+                        index = exponent;
+                        while (index < source.size() && is_class(source[index], number_start))
+                        {
+                            index++;
+                        }
+                    }
+                }
+            }
 
-            if (found_multiple_decimal_points)
+            if (is_separator(source[index - 1]))
             {
-                throw tokenizer_error("Number cannot contain multiple decimal points", expr, location);
+                report_tokenizer_error("Number cannot end with separator characters", expr, { begin, index - begin, 0 });
+                return {};
             }
 
-            tokens.emplace_back(token{
-                .type     = token::token_type::number,
-                .value    = value,
-                .location = location,
-            });
+            type = token::token_type::number;
         }
 
         // Operator, grouped (allows custom operators)
-        else if (operator_chars.contains(expr.expr[index]))
+        else if (is_class(source[index], operator_char))
         {
-            std::size_t begin = index;
-
-            while (index < expr.expr.size() && operator_chars.contains(expr.expr[index]))
+            while (index < source.size() && is_class(source[index], operator_char))
             {
                 index++;
             }
-
-            code_location location = {
-                .begin   = begin,
-                .length  = index - begin,
-                .pointer = 0,
-            };
-
-            std::string value = std::string(expr.expr.substr(location.begin, location.length));
-
-            tokens.emplace_back(token{
-                .type     = token::token_type::symbol,
-                .value    = value,
-                .location = location,
-            });
+            type = token::token_type::symbol;
         }
 
         // Punctuation, ungrouped, only one character for a valid punctuation
-        else if (punctuation_chars.contains(expr.expr[index]))
+        else if (is_class(source[index], punctuation_char))
         {
-            code_location location = {
-                .begin   = index,
-                .length  = 1,
-                .pointer = 0,
-            };
-
-            std::string value = std::string(1, expr.expr[index]);
-
-            tokens.emplace_back(token{
-                .type     = token::token_type::punctuation,
-                .value    = value,
-                .location = location,
-            });
-
             index++;
+            type = token::token_type::punctuation;
         }
 
         // Whitespace
-        else if (std::isspace(expr.expr[index]))
+        else if (is_class(source[index], whitespace))
         {
             index++;
             continue;
@@ -178,24 +220,62 @@ std::vector<fluxins::token> fluxins::tokenize(const code &expr)
         // Invalid character
         else
         {
-            code_location location = {
-                .begin   = index,
-                .length  = 1,
-                .pointer = 0,
-            };
-
-            throw tokenizer_error("Invalid character", expr, location);
+            report_tokenizer_error("Invalid character", expr, { index, 1, 0 });
+            return {};
         }
+
+        tokens.emplace_back(packed_token{
+            .type   = type,
+            .begin  = (std::uint32_t) begin,
+            .length = (std::uint32_t) (index - begin),
+        });
     }
 
     return tokens;
 }
 
+std::vector<fluxins::token> fluxins::tokenize(const code &expr)
+{
+    std::vector<packed_token> packed = tokenize_packed(expr);
+
+    std::vector<token> tokens;
+    tokens.reserve(packed.size());
+
+    for (const auto &tok : packed)
+    {
+        tokens.emplace_back(tok.unpack(expr));
+    }
+
+    return tokens;
+}
+
+std::expected<std::vector<fluxins::packed_token>, fluxins::error_info> fluxins::try_tokenize(const code &expr)
+{
+    return collect_errors([&] { return tokenize_packed(expr); });
+}
+
+std::vector<fluxins::packed_token> fluxins::pack_tokens(const std::vector<token> &tokens)
+{
+    std::vector<packed_token> packed;
+    packed.reserve(tokens.size());
+
+    for (const auto &tok : tokens)
+    {
+        packed.emplace_back(packed_token{
+            .type   = tok.type,
+            .begin  = (std::uint32_t) tok.location.begin,
+            .length = (std::uint32_t) tok.location.length,
+        });
+    }
+
+    return packed;
+}
+
 std::shared_ptr<fluxins::ast_node> fluxins::parse_primary(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
     std::shared_ptr<ast_node> node;
 
@@ -203,31 +283,29 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_primary(
 
     if (pos >= tokens.size())
     {
-        throw unexpected_token("Unexpected end of expression", expr, tokens[pos - 1]);
+        return report_unexpected_token("Unexpected end of expression", expr, tokens[pos - 1]);
     }
 
     // Parse all prefix operators
-    if (tokens[pos].type == token::token_type::symbol)
+    if (tokens[pos].type == token::token_type::symbol &&
+        cfg->find_unary_prefix_op(tokens[pos].value(expr)) != (std::size_t) -1)
     {
-        for (const auto &op_info : cfg->unary_prefix_operators)
-        {
-            if (tokens[pos].value == op_info.symbol)
-            {
-                const token &tok = tokens[pos++];
-
-                auto operand = parse_primary(expr, tokens, cfg, pos);
+        const packed_token &tok = tokens[pos++];
 
-                auto new_node      = std::make_shared<operator_ast>();
-                new_node->symbol   = tok.value;
-                new_node->right    = operand;
-                new_node->location = tok.location;
+        auto operand = parse_primary(expr, tokens, cfg, pos);
+        if (!operand)
+        {
+            return nullptr;
+        }
 
-                node            = new_node;
-                prefix_op_found = true;
+        auto new_node      = std::make_shared<operator_ast>();
+        new_node->symbol   = tok.value(expr);
+        new_node->right    = operand;
+        new_node->location = tok.location();
+        new_node->resolve(*cfg);
 
-                break;
-            }
-        }
+        node            = new_node;
+        prefix_op_found = true;
     }
 
     // No prefix operators, parse core primary expression
@@ -241,7 +319,7 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_primary(
         {
             node = parse_identifier(expr, tokens, cfg, pos);
         }
-        else if (tokens[pos].type == token::token_type::punctuation && tokens[pos].value == "(")
+        else if (tokens[pos].type == token::token_type::punctuation && tokens[pos].value(expr) == "(")
         {
             node = parse_parenthesis(expr, tokens, cfg, pos);
         }
@@ -249,74 +327,111 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_primary(
         {
             // Possibly unreachable code
             // Because the only other token type is symbol, and it is already parsed and consumed
-            throw unexpected_token("Expected number, identifier or punctuation", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+            return report_unexpected_token("Expected number, identifier or punctuation", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+        }
+
+        if (!node)
+        {
+            return nullptr;
         }
     }
 
     // Parse suffix (or more prefix) operators
-    bool more = true;
-
-    while (more && pos < tokens.size() && tokens[pos].type == token::token_type::symbol)
+    while (pos < tokens.size() &&
+           tokens[pos].type == token::token_type::symbol &&
+           cfg->find_unary_suffix_op(tokens[pos].value(expr)) != (std::size_t) -1)
     {
-        more = false;
-        for (const auto &op_info : cfg->unary_suffix_operators)
-        {
-            if (tokens[pos].value == op_info.symbol)
-            {
-                const token &tok      = tokens[pos++];
-                auto         new_node = std::make_shared<operator_ast>();
-                new_node->symbol      = tok.value;
-                new_node->left        = node;
-                new_node->location    = tok.location;
-
-                node = new_node;
-                more = true;
-
-                break;
-            }
-        }
+        const packed_token &tok      = tokens[pos++];
+        auto                new_node = std::make_shared<operator_ast>();
+        new_node->symbol             = tok.value(expr);
+        new_node->left               = node;
+        new_node->location           = tok.location();
+        new_node->resolve(*cfg);
+
+        node = new_node;
     }
+
     return node;
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_number(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
-    const token &tok = tokens[pos++];
+    const packed_token &tok = tokens[pos++];
 
     if (tok.type != token::token_type::number)
     {
         // Possibly unreachable code
         // Because the caller explicitly checks for number token type
-        throw unexpected_token("Expected number", expr, tok);
+        return report_unexpected_token("Expected number", expr, tok);
+    }
+
+    std::string_view value = tok.value(expr);
+
+    // Separators are removed only when present, short numbers do not allocate
+    std::string without_separators;
+    if (value.find_first_of("'_") != std::string_view::npos)
+    {
+        for (char c : value)
+        {
+            if (!is_separator(c))
+            {
+                without_separators += c;
+            }
+        }
+        value = without_separators;
+    }
+
+    std::chars_format format = std::chars_format::general;
+    if (value.starts_with("0x") || value.starts_with("0X"))
+    {
+        format = std::chars_format::hex;
+        value.remove_prefix(2);
+    }
+
+    float number = 0.0f;
+
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number, format);
+
+    if (error == std::errc::result_out_of_range)
+    {
+        report_error({ .message = "Number is out of range", .location = tok.location() }, expr);
+        return nullptr;
+    }
+
+    if (error != std::errc() || end != value.data() + value.size())
+    {
+        // Possibly unreachable code
+        // Because the tokenizer only accepts valid numbers
+        return report_unexpected_token("Invalid number", expr, tok);
     }
 
     auto node      = std::make_shared<number_ast>();
-    node->value    = std::stof(tok.value);
-    node->location = tok.location;
+    node->value    = number;
+    node->location = tok.location();
     return node;
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_identifier(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
     if (tokens[pos].type != token::token_type::identifier)
     {
         // Possibly unreachable code
         // Because the caller explicitly checks for identifier token type
-        throw unexpected_token("Expected identifier", expr, tokens[pos]);
+        return report_unexpected_token("Expected identifier", expr, tokens[pos]);
     }
 
     // Check if identifier is followed by '(' for function
     if (pos + 1 < tokens.size() &&
         tokens[pos + 1].type == token::token_type::punctuation &&
-        tokens[pos + 1].value == "(")
+        tokens[pos + 1].value(expr) == "(")
     {
         return parse_function(expr, tokens, cfg, pos);
     }
@@ -325,45 +440,45 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_identifier(
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_variable(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
-    const token &tok = tokens[pos++];
+    const packed_token &tok = tokens[pos++];
 
     auto node      = std::make_shared<variable_ast>();
-    node->name     = tok.value;
-    node->location = tok.location;
+    node->name     = tok.value(expr);
+    node->location = tok.location();
 
     return node;
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_function(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
     auto node      = std::make_shared<function_ast>();
-    node->name     = tokens[pos].value;
-    node->location = tokens[pos].location;
+    node->name     = tokens[pos].value(expr);
+    node->location = tokens[pos].location();
 
     pos++;
 
     if (pos >= tokens.size() ||
         tokens[pos].type != token::token_type::punctuation ||
-        tokens[pos].value != "(")
+        tokens[pos].value(expr) != "(")
     {
         // Possibly unreachable code
         // Because the caller explicitly checks for '(' token type
-        throw unexpected_token("Expected '(' after function name", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+        return report_unexpected_token("Expected '(' after function name", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
     }
 
     pos++; // Consume '('
 
     // Zero arguments?
-    if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value == ")")
+    if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value(expr) == ")")
     {
         pos++;
         return node;
@@ -372,47 +487,56 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_function(
     // Parse arguments
     while (true)
     {
-        node->args.push_back(parse_all(expr, tokens, cfg, pos));
+        auto arg = parse_all(expr, tokens, cfg, pos);
+        if (!arg)
+        {
+            return nullptr;
+        }
+        node->args.push_back(arg);
 
         // Separate arguments based on ','
-        if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value == ",")
+        if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value(expr) == ",")
         {
             pos++;
             continue;
         }
 
         // Closing parenthesis ends the argument collection
-        if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value == ")")
+        if (pos < tokens.size() && tokens[pos].type == token::token_type::punctuation && tokens[pos].value(expr) == ")")
         {
             pos++;
             break;
         }
 
-        throw unexpected_token("Expected ',' or ')' in function arguments", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+        return report_unexpected_token("Expected ',' or ')' in function arguments", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
     }
 
     return node;
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_parenthesis(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
-    if (tokens[pos].type != token::token_type::punctuation || tokens[pos].value != "(")
+    if (tokens[pos].type != token::token_type::punctuation || tokens[pos].value(expr) != "(")
     {
         // Possibly unreachable code
         // Because the caller explicitly checks for '(' token type
-        throw unexpected_token("Expected '('", expr, tokens[pos]);
+        return report_unexpected_token("Expected '('", expr, tokens[pos]);
     }
 
     pos++; // Consume '('
     auto node = parse_all(expr, tokens, cfg, pos);
+    if (!node)
+    {
+        return nullptr;
+    }
 
-    if (pos >= tokens.size() || tokens[pos].type != token::token_type::punctuation || tokens[pos].value != ")")
+    if (pos >= tokens.size() || tokens[pos].type != token::token_type::punctuation || tokens[pos].value(expr) != ")")
     {
-        throw unexpected_token("Expected ')'", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+        return report_unexpected_token("Expected ')'", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
     }
 
     pos++; // Consume ')'
@@ -420,75 +544,84 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_parenthesis(
     return node;
 }
 
-std::shared_ptr<fluxins::ast_node> fluxins::parse_binary_op(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos,
-    std::size_t               prec)
+/// Parse binary operators with binding power of at least `min_power` using
+/// precedence climbing.
+static std::shared_ptr<fluxins::ast_node> parse_binary_climbing(
+    const fluxins::code                      &expr,
+    const std::vector<fluxins::packed_token> &tokens,
+    std::shared_ptr<fluxins::config>          cfg,
+    std::size_t                              &pos,
+    std::size_t                               min_power)
 {
-    std::shared_ptr<ast_node> left;
+    using fluxins::token;
 
-    if (prec == 0)
-    {
-        left = parse_primary(expr, tokens, cfg, pos);
-    }
-    else
+    auto left = fluxins::parse_primary(expr, tokens, cfg, pos);
+    if (!left)
     {
-        left = parse_binary_op(expr, tokens, cfg, pos, prec - 1);
+        return nullptr;
     }
 
-    // Match operators in the same level of precedence
-    bool matched = true;
-    while (matched && pos < tokens.size())
+    while (pos < tokens.size() && tokens[pos].type == token::token_type::symbol)
     {
-        matched = false;
-        for (std::size_t i : cfg->binary_op_precedence[prec])
+        std::size_t index = cfg->find_binary_op(tokens[pos].value(expr));
+
+        // Not a binary operator, or the operator has no precedence
+        if (index == (std::size_t) -1 || index >= cfg->binary_op_bindings.size())
         {
-            const auto &op_info = cfg->binary_operators[i];
+            break;
+        }
 
-            // Operator did not match
-            if (tokens[pos].type != token::token_type::symbol || tokens[pos].value != op_info.symbol)
-            {
-                continue;
-            }
+        std::size_t power = cfg->binary_op_bindings[index].power;
 
-            matched          = true;
-            const token &tok = tokens[pos++];
+        // Operator binds looser, it is parsed by the caller
+        if (power == 0 || power < min_power)
+        {
+            break;
+        }
 
-            std::shared_ptr<ast_node> right;
-            if (prec == 0)
-            {
-                right = parse_primary(expr, tokens, cfg, pos);
-            }
-            else if (op_info.assoc == associativity::right)
-            {
-                right = parse_binary_op(expr, tokens, cfg, pos, prec);
-            }
-            else if (op_info.assoc == associativity::left)
-            {
-                right = parse_binary_op(expr, tokens, cfg, pos, prec - 1);
-            }
+        // Associativity is read from the operator, which may be modified
+        // in-place. The operand of the most precedent operators is always a
+        // primary expression, they are never parsed as right associative
+        bool        right       = cfg->binary_operators[index].assoc == fluxins::associativity::right && power != cfg->binary_op_precedence.size();
+        std::size_t right_power = right ? power : power + 1;
 
-            auto new_node      = std::make_shared<operator_ast>();
-            new_node->symbol   = tok.value;
-            new_node->left     = left;
-            new_node->right    = right;
-            new_node->location = tok.location;
-            left               = new_node;
+        const fluxins::packed_token &tok = tokens[pos++];
 
-            break;
+        auto right_node = parse_binary_climbing(expr, tokens, cfg, pos, right_power);
+        if (!right_node)
+        {
+            return nullptr;
         }
+
+        auto new_node      = std::make_shared<fluxins::operator_ast>();
+        new_node->symbol   = tok.value(expr);
+        new_node->left     = left;
+        new_node->right    = right_node;
+        new_node->location = tok.location();
+        new_node->resolve(*cfg);
+        left = new_node;
     }
 
     return left;
 }
 
+std::shared_ptr<fluxins::ast_node> fluxins::parse_binary_op(
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos,
+    std::size_t                      prec)
+{
+    // Precedence level is counted from the most precedent, binding power is
+    // counted from the least precedent
+    return parse_binary_climbing(expr, tokens, cfg, pos, cfg->binary_op_precedence.size() - prec);
+}
+
 std::shared_ptr<fluxins::ast_node> fluxins::parse_condition(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
     std::shared_ptr<ast_node> condition;
 
@@ -503,23 +636,31 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_condition(
     }
 
     // No '?' operator found, not a conditional operator
-    if (pos >= tokens.size() || tokens[pos].type != token::token_type::symbol || tokens[pos].value != "?")
+    if (!condition || pos >= tokens.size() || tokens[pos].type != token::token_type::symbol || tokens[pos].value(expr) != "?")
     {
         return condition;
     }
 
-    code_location location = tokens[pos].location; // Location to the '?'
+    code_location location = tokens[pos].location(); // Location to the '?'
     pos++;
 
     auto true_value = parse_all(expr, tokens, cfg, pos);
+    if (!true_value)
+    {
+        return nullptr;
+    }
 
-    if (pos >= tokens.size() || tokens[pos].value != ":")
+    if (pos >= tokens.size() || tokens[pos].value(expr) != ":")
     {
-        throw unexpected_token("Expected ':' in conditional expression", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
+        return report_unexpected_token("Expected ':' in conditional expression", expr, pos >= tokens.size() ? tokens[pos - 1] : tokens[pos]);
     }
 
     pos++;
     auto false_value = parse_all(expr, tokens, cfg, pos);
+    if (!false_value)
+    {
+        return nullptr;
+    }
 
     auto node         = std::make_shared<conditional_ast>();
     node->condition   = condition;
@@ -531,18 +672,18 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse_condition(
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse_all(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg,
-    std::size_t              &pos)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg,
+    std::size_t                     &pos)
 {
     return parse_condition(expr, tokens, cfg, pos);
 }
 
 std::shared_ptr<fluxins::ast_node> fluxins::parse(
-    const code               &expr,
-    const std::vector<token> &tokens,
-    std::shared_ptr<config>   cfg)
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg)
 {
     if (tokens.empty())
     {
@@ -555,10 +696,75 @@ std::shared_ptr<fluxins::ast_node> fluxins::parse(
     std::size_t pos  = 0;
     auto        node = parse_all(expr, tokens, cfg, pos);
 
-    if (pos != tokens.size())
+    if (node && pos != tokens.size())
     {
-        throw unexpected_token("Unexpected tokens after expression", expr, tokens[pos]);
+        return report_unexpected_token("Unexpected tokens after expression", expr, tokens[pos]);
     }
 
     return node;
 }
+
+std::shared_ptr<fluxins::ast_node> fluxins::parse(
+    const code               &expr,
+    const std::vector<token> &tokens,
+    std::shared_ptr<config>   cfg)
+{
+    return parse(expr, pack_tokens(tokens), cfg);
+}
+
+std::expected<std::shared_ptr<fluxins::ast_node>, fluxins::error_info> fluxins::try_parse(
+    const code                      &expr,
+    const std::vector<packed_token> &tokens,
+    std::shared_ptr<config>          cfg)
+{
+    return collect_errors([&] { return parse(expr, tokens, cfg); });
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::number_ast::clone() const
+{
+    return std::make_shared<number_ast>(*this);
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::variable_ast::clone() const
+{
+    auto copy  = std::make_shared<variable_ast>(*this);
+    copy->slot = nullptr;
+    return copy;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::function_ast::clone() const
+{
+    auto copy    = std::make_shared<function_ast>(*this);
+    copy->target = nullptr;
+    for (auto &arg : copy->args)
+    {
+        arg = arg->clone();
+    }
+    return copy;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::operator_ast::clone() const
+{
+    auto copy = std::make_shared<operator_ast>(*this);
+    if (left) copy->left = left->clone();
+    if (right) copy->right = right->clone();
+    return copy;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::conditional_ast::clone() const
+{
+    auto copy         = std::make_shared<conditional_ast>(*this);
+    copy->condition   = condition->clone();
+    copy->true_value  = true_value->clone();
+    copy->false_value = false_value->clone();
+    return copy;
+}
+
+std::shared_ptr<fluxins::ast_node> fluxins::shared_ast::clone() const
+{
+    // Each parent gets its own copy, the slot still identifies the shared
+    // subexpression when compiling
+    auto copy  = std::make_shared<shared_ast>(*this);
+    copy->node = node->clone();
+    return copy;
+}
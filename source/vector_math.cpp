@@ -0,0 +1,441 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source file provides implementation for vectorized math kernels.
+///
+/// Every kernel processes the values block by block, with loops over the
+/// block without branches, library calls or 64-bit integer comparisons, which
+/// the compiler turns into SIMD instructions (even with SSE2 only). Rare
+/// special values are fixed up afterwards with the scalar `<cmath>` functions.
+///
+/// With GCC on x86-64 Linux, the kernels are also compiled for AVX2 with FMA
+/// and for AVX-512 (`target_clones`), and the widest instruction set supported
+/// by the processor is selected when the library is loaded.
+///
+/// The transcendental functions are evaluated in double precision using
+/// reductions into a small range followed by polynomials (with an error below
+/// 2^-34), so rounding the result to `float` gives at most 1 ULP of error.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+
+#include "fluxins/vector_math.hpp"
+
+using fluxins::simd::block_size;
+
+// Kernels are compiled for each instruction set, selected when loaded
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(__AVX512F__)
+#define FLUXINS_SIMD_DISPATCH __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#define FLUXINS_SIMD_DISPATCHED
+#else
+#define FLUXINS_SIMD_DISPATCH
+#endif
+
+/// Adding and subtracting this rounds a double to the nearest integer, and the
+/// low bits of the sum hold that integer.
+static constexpr double round_magic = 0x1.8p52;
+
+/// High part of pi / 2 (33 bits), multiplying it by an integer below 2^20 is
+/// exact.
+static constexpr double pio2_hi = 1.57079632673412561417e+00;
+
+/// Low part of pi / 2, `pi / 2 - pio2_hi`.
+static constexpr double pio2_lo = 6.07710050650619224932e-11;
+
+static inline std::uint64_t to_bits(double x)
+{
+    return std::bit_cast<std::uint64_t>(x);
+}
+
+static inline double from_bits(std::uint64_t x)
+{
+    return std::bit_cast<double>(x);
+}
+
+/// Select `a` where the mask is all ones and `b` where it is zero, 64-bit
+/// comparisons are not available with SSE2.
+static inline double select(std::uint64_t mask, double a, double b)
+{
+    return from_bits((to_bits(a) & mask) | (to_bits(b) & ~mask));
+}
+
+/// e^r for |r| <= ln(2) / 2, Taylor series up to r^9.
+static inline double exp_reduced(double r)
+{
+    double p = 1.0 / 362880.0;
+    p        = p * r + 1.0 / 40320.0;
+    p        = p * r + 1.0 / 5040.0;
+    p        = p * r + 1.0 / 720.0;
+    p        = p * r + 1.0 / 120.0;
+    p        = p * r + 1.0 / 24.0;
+    p        = p * r + 1.0 / 6.0;
+    p        = p * r + 1.0 / 2.0;
+    p        = p * r + 1.0;
+    return p * r + 1.0;
+}
+
+/// 2^w for |w| <= 1000.
+static inline double exp2_double(double w)
+{
+    double t = w + round_magic;
+    double n = t - round_magic;
+
+    // 2^n built directly from the exponent bits
+    double scale = from_bits((to_bits(t) - to_bits(round_magic) + 1023) << 52);
+    return exp_reduced((w - n) * std::numbers::ln2) * scale;
+}
+
+/// log2(x) for positive, finite x.
+static inline double log2_double(double x)
+{
+    std::uint64_t bits = to_bits(x);
+
+    // Split into x = m * 2^e with m in [sqrt(2) / 2, sqrt(2)]
+    double e    = from_bits((bits >> 52) | to_bits(0x1p52)) - (0x1p52 + 1023.0);
+    double m    = from_bits((bits & 0x000FFFFFFFFFFFFF) | to_bits(1.0));
+    bool   half = m > std::numbers::sqrt2;
+    m           = half ? m * 0.5 : m;
+    e           = half ? e + 1.0 : e;
+
+    // ln(m) = 2 * atanh(s), series up to s^13
+    double s = (m - 1.0) / (m + 1.0);
+    double z = s * s;
+    double p = 1.0 / 13.0;
+    p        = p * z + 1.0 / 11.0;
+    p        = p * z + 1.0 / 9.0;
+    p        = p * z + 1.0 / 7.0;
+    p        = p * z + 1.0 / 5.0;
+    p        = p * z + 1.0 / 3.0;
+    p        = p * z + 1.0;
+
+    return e + 2.0 * s * p * std::numbers::log2e;
+}
+
+/// sin(r) for |r| <= pi / 4, minimax polynomial up to r^9 with a relative
+/// error below 2^-37.
+static inline double sin_reduced(double r)
+{
+    double z = r * r;
+    double p = 0x16cd878c3b46a7.0p-71;
+    p        = p * z - 0x1a00f9e2cae774.0p-65;
+    p        = p * z + 0x111110896efbb2.0p-59;
+    p        = p * z - 0x15555554cbac77.0p-55;
+    return r + r * z * p;
+}
+
+/// cos(r) for |r| <= pi / 4, minimax polynomial up to r^8 with an error below
+/// 2^-34.
+static inline double cos_reduced(double r)
+{
+    double z = r * r;
+    double p = 0x199342e0ee5069.0p-68;
+    p        = p * z - 0x16c087e80f1e27.0p-62;
+    p        = p * z + 0x155553e1053a42.0p-57;
+    p        = p * z - 0x1ffffffd0c5e81.0p-54;
+    return p * z + 1.0;
+}
+
+/// Reduce x (|x| <= 65536) into |r| <= pi / 4, the low bits of `quadrant` hold
+/// the number of quarter turns removed.
+static inline double reduce_quadrant(double x, std::uint64_t &quadrant)
+{
+    double t = x * (2.0 / std::numbers::pi) + round_magic;
+    double q = t - round_magic;
+    quadrant = to_bits(t);
+    return (x - q * pio2_hi) - q * pio2_lo;
+}
+
+/// Apply a block kernel to all the values. Results are collected before being
+/// stored as the output may be the same memory as the input.
+template <void (*kernel)(const float *x, float *result, std::size_t count)>
+FLUXINS_SIMD_DISPATCH static void apply(std::span<const float> x, std::span<float> output)
+{
+    float result[block_size];
+    for (std::size_t i = 0; i < output.size(); i += block_size)
+    {
+        std::size_t count = std::min(block_size, output.size() - i);
+        kernel(x.data() + i, result, count);
+        std::copy_n(result, count, output.data() + i);
+    }
+}
+
+/// Apply a block kernel of two parameters to all the values.
+template <void (*kernel)(const float *x, const float *y, float *result, std::size_t count)>
+FLUXINS_SIMD_DISPATCH static void apply(std::span<const float> x, std::span<const float> y, std::span<float> output)
+{
+    float result[block_size];
+    for (std::size_t i = 0; i < output.size(); i += block_size)
+    {
+        std::size_t count = std::min(block_size, output.size() - i);
+        kernel(x.data() + i, y.data() + i, result, count);
+        std::copy_n(result, count, output.data() + i);
+    }
+}
+
+// Block kernels, compute `result[i]` for the first `count` values
+
+static inline void ceil_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) result[i] = std::ceil(x[i]);
+}
+
+static inline void floor_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) result[i] = std::floor(x[i]);
+}
+
+static inline void trunc_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) result[i] = std::trunc(x[i]);
+}
+
+static inline void sqrt_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) result[i] = std::sqrt(x[i]);
+}
+
+static inline void exp_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        // Beyond these, the result underflows to zero or overflows to infinity
+        // (NaN passes through)
+        double w  = x[i];
+        w         = w < -104.0 ? -104.0 : w;
+        w         = w > 89.0 ? 89.0 : w;
+        result[i] = (float) exp2_double(w * std::numbers::log2e);
+    }
+}
+
+static inline void exp2_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double w  = x[i];
+        w         = w < -151.0 ? -151.0 : w;
+        w         = w > 129.0 ? 129.0 : w;
+        result[i] = (float) exp2_double(w);
+    }
+}
+
+/// Logarithm kernels only differ in the scale of the base-2 logarithm.
+template <double (*scale)()>
+static inline void log_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        result[i] = (float) (log2_double(x[i]) * scale());
+    }
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (!(x[i] > 0.0f && x[i] <= std::numeric_limits<float>::max()))
+        {
+            result[i] = (float) (std::log2(x[i]) * scale());
+        }
+    }
+}
+
+static constexpr double scale_ln()
+{
+    return std::numbers::ln2;
+}
+
+static constexpr double scale_log2()
+{
+    return 1.0;
+}
+
+static constexpr double scale_log10()
+{
+    return std::numbers::ln2 / std::numbers::ln10;
+}
+
+/// Trigonometric kernels, `quarter` turns are added to the argument (cos is a
+/// sine turned by a quarter), or the tangent is computed instead.
+template <std::uint64_t quarter, bool tangent, float (*fallback)(float)>
+static inline void trig_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::uint64_t quadrant = 0;
+        double        value    = x[i];
+        double        r        = reduce_quadrant(value, quadrant);
+        double        s        = sin_reduced(r);
+        double        c        = cos_reduced(r);
+        quadrant += quarter;
+
+        // Odd quadrants swap sine and cosine, the second half turn negates
+        std::uint64_t odd = 0 - (quadrant & 1);
+        if constexpr (tangent)
+        {
+            value = select(odd, -c, s) / select(odd, s, c);
+        }
+        else
+        {
+            value = from_bits(to_bits(select(odd, c, s)) ^ ((quadrant & 2) << 62));
+        }
+
+        // Keep the sign of zero for odd functions
+        if constexpr (quarter == 0)
+        {
+            value = x[i] == 0.0f ? (double) x[i] : value;
+        }
+        result[i] = (float) value;
+    }
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (!(std::fabs(x[i]) <= 65536.0f))
+        {
+            result[i] = fallback(x[i]);
+        }
+    }
+}
+
+static float scalar_sin(float x)
+{
+    return std::sin(x);
+}
+
+static float scalar_cos(float x)
+{
+    return std::cos(x);
+}
+
+static float scalar_tan(float x)
+{
+    return std::tan(x);
+}
+
+static inline void tanh_block(const float *x, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double a = std::fabs(x[i]);
+        a        = a > 20.0 ? 20.0 : a;
+
+        // Near zero, (e - 1) / (e + 1) would lose precision to cancellation
+        double z     = a * a;
+        double small = 62.0 / 2835.0;
+        small        = small * z - 17.0 / 315.0;
+        small        = small * z + 2.0 / 15.0;
+        small        = small * z - 1.0 / 3.0;
+        small        = a + a * z * small;
+
+        double e     = exp2_double(2.0 * a * std::numbers::log2e);
+        double large = (e - 1.0) / (e + 1.0);
+
+        double value = a < 0.05 ? small : large;
+        result[i]    = (float) std::copysign(value, (double) x[i]);
+    }
+}
+
+static inline void pow_block(const float *x, const float *y, float *result, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        double w  = y[i] * log2_double(x[i]);
+        w         = w < -151.0 ? -151.0 : w;
+        w         = w > 129.0 ? 129.0 : w;
+        result[i] = (float) exp2_double(w);
+    }
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (!(x[i] > 0.0f && x[i] <= std::numeric_limits<float>::max() && std::fabs(y[i]) <= std::numeric_limits<float>::max()))
+        {
+            result[i] = std::pow(x[i], y[i]);
+        }
+    }
+}
+
+// Implementation
+
+bool fluxins::simd::wide_vectors()
+{
+#if defined(__AVX2__) && defined(__FMA__)
+    return true;
+#elif defined(FLUXINS_SIMD_DISPATCHED)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+void fluxins::simd::ceil(std::span<const float> x, std::span<float> output)
+{
+    apply<ceil_block>(x, output);
+}
+
+void fluxins::simd::floor(std::span<const float> x, std::span<float> output)
+{
+    apply<floor_block>(x, output);
+}
+
+void fluxins::simd::trunc(std::span<const float> x, std::span<float> output)
+{
+    apply<trunc_block>(x, output);
+}
+
+void fluxins::simd::sqrt(std::span<const float> x, std::span<float> output)
+{
+    apply<sqrt_block>(x, output);
+}
+
+void fluxins::simd::exp(std::span<const float> x, std::span<float> output)
+{
+    apply<exp_block>(x, output);
+}
+
+void fluxins::simd::exp2(std::span<const float> x, std::span<float> output)
+{
+    apply<exp2_block>(x, output);
+}
+
+void fluxins::simd::log(std::span<const float> x, std::span<float> output)
+{
+    apply<log_block<scale_ln>>(x, output);
+}
+
+void fluxins::simd::log2(std::span<const float> x, std::span<float> output)
+{
+    apply<log_block<scale_log2>>(x, output);
+}
+
+void fluxins::simd::log10(std::span<const float> x, std::span<float> output)
+{
+    apply<log_block<scale_log10>>(x, output);
+}
+
+void fluxins::simd::sin(std::span<const float> x, std::span<float> output)
+{
+    apply<trig_block<0, false, scalar_sin>>(x, output);
+}
+
+void fluxins::simd::cos(std::span<const float> x, std::span<float> output)
+{
+    apply<trig_block<1, false, scalar_cos>>(x, output);
+}
+
+void fluxins::simd::tan(std::span<const float> x, std::span<float> output)
+{
+    apply<trig_block<0, true, scalar_tan>>(x, output);
+}
+
+void fluxins::simd::tanh(std::span<const float> x, std::span<float> output)
+{
+    apply<tanh_block>(x, output);
+}
+
+void fluxins::simd::pow(std::span<const float> x, std::span<const float> y, std::span<float> output)
+{
+    apply<pow_block>(x, y, output);
+}
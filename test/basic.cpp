@@ -14,7 +14,9 @@
 #include "doctest/doctest.h"
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
 #include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
 
 TEST_CASE("Basic expression parsing and evaluation")
 {
@@ -86,3 +88,84 @@ TEST_CASE("Basic expression with shared context")
     CHECK(fluxins::express("p + square(p)", cfg, ctx4) == 12.0f);
     CHECK(fluxins::express("square(p + 2)", cfg, ctx4) == 25.0f);
 }
+
+TEST_CASE("Basic number literals")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    CHECK(fluxins::express("12.5", cfg) == 12.5f);
+    CHECK(fluxins::express("1.", cfg) == 1.0f);
+    CHECK(fluxins::express("1'000 + 2_000", cfg) == 3000.0f);
+    CHECK(fluxins::express("1e3", cfg) == 1000.0f);
+    CHECK(fluxins::express("1e-3", cfg) == 0.001f);
+    CHECK(fluxins::express("2.5E+2 - 1", cfg) == 249.0f);
+    CHECK(fluxins::express("0xFF + 0x10", cfg) == 271.0f);
+    CHECK(fluxins::express("0X7f'ff", cfg) == 32767.0f);
+
+    // Exponent without digits is not a part of the number
+    auto tokens = fluxins::tokenize("2e + 1");
+    REQUIRE(tokens.size() == 4);
+    CHECK(tokens[0].value == "2");
+    CHECK(tokens[1].value == "e");
+
+    CHECK_THROWS_AS(fluxins::express("1e50", cfg), fluxins::code_error);
+    CHECK_THROWS_AS(fluxins::express("0x1_", cfg), fluxins::tokenizer_error);
+}
+
+TEST_CASE("Basic expression evaluation with borrowed frame")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+
+    fluxins::expression expr("max(x, 2) * 2 + -x", cfg, ctx);
+    expr.parse();
+
+    fluxins::evaluation_frame frame = { expr.expr, *cfg, ctx.get() };
+    CHECK(expr.ast->evaluate(frame) == 3.0f);
+    CHECK(expr.ast->evaluate(expr.expr, cfg, ctx) == 3.0f);
+
+    // Frame without context can only evaluate constants
+    fluxins::evaluation_frame no_symbols = { expr.expr, *cfg };
+    CHECK_THROWS_AS(expr.ast->evaluate(no_symbols), fluxins::unresolved_reference);
+}
+
+TEST_CASE("Basic expression parsing with packed tokens")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+
+    fluxins::code expr = "max(x, 2.5) * 2 + -x";
+
+    auto packed = fluxins::tokenize_packed(expr);
+    auto tokens = fluxins::tokenize(expr);
+    REQUIRE(packed.size() == tokens.size());
+    CHECK(sizeof(fluxins::packed_token) <= 12);
+
+    for (std::size_t i = 0; i < packed.size(); i++)
+    {
+        CHECK(packed[i].type == tokens[i].type);
+        CHECK(packed[i].value(expr) == tokens[i].value);
+        CHECK(packed[i].begin == tokens[i].location.begin);
+        CHECK(packed[i].length == tokens[i].location.length);
+    }
+
+    CHECK(packed[4].value(expr) == "2.5");
+    CHECK(packed[9].type == fluxins::token::token_type::symbol);
+    CHECK(packed[9].value(expr) == "-");
+
+    // Adjacent symbols are grouped into one token
+    fluxins::code comparison = "a <= b";
+    auto          grouped    = fluxins::tokenize_packed(comparison);
+    REQUIRE(grouped.size() == 3);
+    CHECK(grouped[1].value(comparison) == "<=");
+
+    auto ast = fluxins::parse(expr, packed, cfg);
+    CHECK(ast->evaluate(expr, cfg, ctx) == 3.0f);
+
+    CHECK_THROWS_AS(fluxins::tokenize_packed("1 # 2"), fluxins::tokenizer_error);
+    CHECK_THROWS_AS(fluxins::parse("(1", fluxins::tokenize_packed("(1"), cfg), fluxins::unexpected_token);
+}
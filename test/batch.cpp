@@ -0,0 +1,290 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests batched evaluation against the AST evaluator.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/batch.hpp"
+#include "fluxins/bytecode.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
+
+TEST_CASE("Batch evaluation matches AST evaluation")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("z", 0);
+
+    // More rows than a single block, with a partial last block
+    std::size_t        rows = fluxins::batch_block_size * 2 + 37;
+    std::vector<float> xs(rows), ys(rows);
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        xs[i] = (float) i / 7.0f - 20.0f;
+        ys[i] = (float) (i % 5) - 2.0f;
+    }
+    ys[3] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+        { "y", ys },
+    };
+
+    std::vector<std::string> expressions = {
+        "42",
+        "x",
+        "1 + 2 * x - y / 5",
+        "-x + +y * *x",
+        "!x + !y + !z",
+        "x ** 2 + y ** 2",
+        "x %% 2 + x // 2",
+        "x <? y >? 0",
+        "(x == y) + (x != y) + (x < y) + (x > y) + (x <= y) + (x >= y)",
+        "x && y + (z || y)",
+        "z ? x : y",
+        "y ? x : 10",
+        "x > 0 ? y ? 1 : 2 : 3",
+        "y ? x / y : 0",
+        "max(x, y, 4) + min(x, y) + avg(1, x, 3)",
+        "sqrt(x * x + y * y) / (1 + sqrt(x * x + y * y))",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression batch(text, cfg, ctx);
+        batch.parse();
+
+        std::vector<float> output(rows);
+        batch.evaluate_batch(columns, output);
+
+        for (std::size_t i = 0; i < rows; i++)
+        {
+            CAPTURE(i);
+
+            ctx->set_variable("x", xs[i]);
+            ctx->set_variable("y", ys[i]);
+
+            fluxins::expression tree(text, cfg, ctx);
+            tree.parse();
+            tree.evaluate();
+
+            if (std::isnan(tree.value))
+            {
+                CHECK(std::isnan(output[i]));
+            }
+            else
+            {
+                CHECK(output[i] == tree.value);
+            }
+        }
+
+        ctx->variables.erase("x");
+        ctx->variables.erase("y");
+    }
+}
+
+TEST_CASE("Batch evaluation with context variables and functions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("scale * double(x)", cfg);
+    expr.set_variable("scale", 3);
+    expr.set_function("double", [](FLUXINS_FN_PARAMS) { return params[0] * 2; });
+    expr.parse();
+
+    std::vector<float>           xs = { 1, 2, 3 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+
+    std::vector<float> output(3);
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 6, 12, 18 });
+
+    // Columns take precedence over context variables
+    std::vector<float> scales = { 1, 0, -1 };
+    columns.push_back({ "scale", scales });
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 2, 0, -6 });
+
+    // Fewer rows than the columns have
+    std::vector<float> partial(2);
+    expr.evaluate_batch(columns, partial);
+    CHECK(partial == std::vector<float> { 2, 0 });
+
+    // No rows at all
+    expr.evaluate_batch(columns, std::span<float> {});
+}
+
+TEST_CASE("Batch evaluation of impure functions with different branches")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    // Rows of the block take different branches after calling the function
+    std::size_t        rows = fluxins::batch_block_size + 3;
+    std::vector<float> xs(rows);
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        xs[i] = (float) (i % 3);
+    }
+
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+
+    int                 calls = 0;
+    fluxins::expression expr("count(x) ? count(x) + x : -x", cfg);
+    expr.set_function("count", [&](FLUXINS_FN_PARAMS) {
+        calls++;
+        return params[0];
+    });
+    expr.parse();
+
+    std::vector<float> output(rows);
+    expr.evaluate_batch(columns, output);
+
+    int expected_calls = 0;
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        CAPTURE(i);
+        CHECK(output[i] == (xs[i] != 0.0f ? 2.0f * xs[i] : -xs[i]));
+        expected_calls += xs[i] != 0.0f ? 2 : 1;
+    }
+
+    // Same number of calls as evaluating the rows one by one
+    CHECK(calls == expected_calls);
+}
+
+TEST_CASE("Batch evaluation errors")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    std::vector<float>           xs = { 1, 2, 0 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+
+    auto batch = [&](const std::string &text, std::size_t rows) {
+        fluxins::expression expr(text, cfg);
+        expr.parse();
+        std::vector<float> output(rows);
+        expr.evaluate_batch(columns, output);
+        return output;
+    };
+
+    CHECK_THROWS_AS(batch("x", 4), std::invalid_argument);
+    CHECK_THROWS_AS(batch("x + y", 3), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(batch("f(x)", 3), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(batch("1 / x", 3), fluxins::code_error);
+    CHECK_THROWS_AS(batch("/x", 3), fluxins::code_error);
+    CHECK(batch("1 / x", 2) == std::vector<float> { 1.0f, 0.5f });
+    CHECK(batch("x ? 1 / x : y", 2) == std::vector<float> { 1.0f, 0.5f });
+}
+
+TEST_CASE("Batch evaluation without context")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    std::vector<float>           xs = { 1, 2, 3 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+    std::vector<float> output(3);
+
+    auto batch = [&](const std::string &text) {
+        fluxins::code code(text);
+        auto          ast = fluxins::parse(code, fluxins::tokenize(code), cfg);
+        fluxins::execute_batch(fluxins::compile(code, ast, cfg), code, cfg, nullptr, columns, output);
+        return output;
+    };
+
+    CHECK(batch("x * 2") == std::vector<float> { 2, 4, 6 });
+    CHECK_THROWS_AS(batch("x + y"), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(batch("f(x)"), fluxins::unresolved_reference);
+
+    auto error = fluxins::collect_errors([&] { return batch("y")[0]; });
+    REQUIRE_FALSE(error.has_value());
+    CHECK(error.error().kind == fluxins::error_kind::unresolved_reference);
+    CHECK(error.error().symbol == "y");
+}
+
+TEST_CASE("Batch evaluation with modified config")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    cfg->add_binary_op({ "***", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x * y; } });
+    cfg->assign_precedence("+++", 0zu);
+    cfg->assign_precedence("***", 0zu);
+
+    std::vector<float>           xs = { 1, 2, 3 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+    std::vector<float> output(3);
+
+    fluxins::expression expr("x *** 2", cfg);
+    expr.parse();
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 2, 4, 6 });
+
+    // Index of the operator changes, the expression is compiled again
+    cfg->remove_binary_op("+++");
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 2, 4, 6 });
+
+    // Stale bytecode is not executed
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    CHECK_THROWS_AS(fluxins::execute_batch(expr.program, expr.expr, cfg, expr.ctx, columns, output), fluxins::code_error);
+
+    cfg->remove_binary_op("***");
+    CHECK_THROWS_AS(expr.evaluate_batch(columns, output), fluxins::unresolved_reference);
+}
+
+TEST_CASE("Batch evaluation with replaced built-in operators")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    std::vector<float>           xs = { 1, 2, 3 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+    std::vector<float> output(3);
+
+    fluxins::expression expr("-x + 2", cfg);
+    expr.parse();
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 1, 0, -1 });
+
+    // Replaced through the reference, the replaced functions are called
+    cfg->get_binary_op("+").operate       = [](FLUXINS_BOP_PARAMS) { return x * 100 + y; };
+    cfg->get_unary_prefix_op("-").operate = [](FLUXINS_UOP_PARAMS) { return x * 10; };
+    expr.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 1002, 2002, 3002 });
+
+    fluxins::expression fresh("1 + x", cfg);
+    fresh.parse();
+    fresh.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 101, 102, 103 });
+    CHECK(fluxins::express("1 + 2", cfg) == 102.0f);
+}
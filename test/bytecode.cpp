@@ -0,0 +1,418 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests bytecode compilation and interpretation against the
+/// AST evaluator.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/bytecode.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
+
+TEST_CASE("Bytecode matches AST evaluation")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+    ctx->set_variable("y", -2.5f);
+    ctx->set_variable("flag", 0);
+
+    std::vector<std::string> expressions = {
+        "",
+        "42",
+        "1 + 2 * 3",
+        "(1 + 2) * 3 - 4 / 5 + 2 ** (1 + 1)",
+        "-x + +y * *x / /y",
+        "3! + !0 + ~5",
+        "x ** 2 ** 0.5",
+        "x %% 2 + y % 2 + x // 2",
+        "x <? y >? 0 !! 1",
+        "flag ?? x",
+        "flag ? x : y",
+        "x ? flag ? 1 : 2 : 3",
+        "(x > y ? x : y) * (flag ? 10 : 20)",
+        "max(x, y, 4) + min(x, y) + avg(1, 2, 3)",
+        "sqrt(x * x + y * y) / (1 + sqrt(x * x + y * y))",
+        "clamp(x * 10, 0, 5) + hypot(x, y)",
+        "x == 3 && y < 0 || flag",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression tree(text, cfg, ctx);
+        tree.parse();
+        tree.evaluate();
+
+        fluxins::expression compiled(text, cfg, ctx);
+        compiled.parse();
+        compiled.compile();
+        REQUIRE_FALSE(compiled.program.instructions.empty());
+        compiled.evaluate();
+
+        CHECK(compiled.value == doctest::Approx(tree.value));
+    }
+}
+
+TEST_CASE("Bytecode stack depth")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression shallow("1 + 2 + 3 + 4", cfg);
+    shallow.parse();
+    shallow.compile();
+    CHECK(shallow.program.max_stack == 2);
+    CHECK(shallow.program.depth == 1);
+
+    fluxins::expression conditional("1 ? 2 : 3", cfg);
+    conditional.parse();
+    conditional.compile();
+    CHECK(conditional.program.max_stack == 1);
+    CHECK(conditional.program.depth == 1);
+
+    // Deeper than the interpreter's small stack
+    std::string deep = "1";
+    for (int i = 0; i < 50; i++)
+    {
+        deep = "1 + (" + deep + ")";
+    }
+
+    fluxins::expression deep_expr(deep, cfg);
+    deep_expr.parse();
+    deep_expr.compile();
+    CHECK(deep_expr.program.max_stack == 51);
+    deep_expr.evaluate();
+    CHECK(deep_expr.value == 51.0f);
+}
+
+TEST_CASE("Bytecode re-evaluation with modified context")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("x * 2 + double(x)", cfg);
+    expr.set_variable("x", 1);
+    expr.set_function("double", [](FLUXINS_FN_PARAMS) { return params[0] * 2; });
+
+    CHECK(expr.get_value() == 4.0f);
+    REQUIRE_FALSE(expr.program.instructions.empty());
+
+    expr.ctx->variables["x"] = 5;
+    expr.evaluate();
+    CHECK(expr.value == 20.0f);
+
+    expr.set_function("double", [](FLUXINS_FN_PARAMS) { return params[0] * 3; });
+    expr.evaluate();
+    CHECK(expr.value == 25.0f);
+
+    // Parsing again discards the stale bytecode
+    expr.expr = "x";
+    expr.parse();
+    CHECK(expr.program.instructions.empty());
+    expr.evaluate();
+    CHECK(expr.value == 5.0f);
+}
+
+TEST_CASE("Bytecode errors")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    ctx->set_function("add", [](FLUXINS_FN_PARAMS) {
+        FLUXINS_FN_ARITY("add", 2);
+        return params[0] + params[1];
+    });
+
+    CHECK_THROWS_AS(fluxins::express("x + 1", cfg, ctx), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(fluxins::express("function(1)", cfg, ctx), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(fluxins::express("add(1)", cfg, ctx), fluxins::invalid_arity);
+    CHECK_THROWS_AS(fluxins::express("1 / 0", cfg, ctx), fluxins::code_error);
+    CHECK_NOTHROW(fluxins::express("1 ? 1 : 1 / 0", cfg, ctx));
+
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    cfg->assign_precedence("+++", 0zu);
+
+    fluxins::expression expr("1 +++ 2", cfg, ctx);
+    expr.parse();
+    cfg->remove_binary_op("+++");
+
+    CHECK_THROWS_AS(expr.compile(), fluxins::unresolved_reference);
+}
+
+TEST_CASE("Bytecode with modified config")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    cfg->add_binary_op({ "***", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x * y; } });
+    cfg->assign_precedence("+++", 0zu);
+    cfg->assign_precedence("***", 0zu);
+
+    ctx->set_variable("x", 2);
+
+    fluxins::expression expr("x *** 3", cfg, ctx);
+    CHECK(expr.get_value() == 6.0f);
+    REQUIRE_FALSE(expr.program.instructions.empty());
+    CHECK(expr.program.version == cfg->version);
+
+    // Index of the operator changes, the expression is compiled again
+    cfg->remove_binary_op("+++");
+    expr.evaluate();
+    CHECK(expr.value == 6.0f);
+    CHECK(expr.program.version == cfg->version);
+
+    // Stale bytecode is not executed
+    fluxins::bytecode stale = expr.program;
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    CHECK_THROWS_AS(fluxins::execute(stale, expr.expr, cfg, ctx), fluxins::code_error);
+    CHECK_FALSE(fluxins::try_execute(stale, expr.expr, cfg, ctx).has_value());
+
+    cfg->remove_binary_op("***");
+    CHECK_THROWS_AS(expr.evaluate(), fluxins::unresolved_reference);
+    CHECK_FALSE(expr.try_evaluate().has_value());
+}
+
+TEST_CASE("Variable binding")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    auto parent_ctx = std::make_shared<fluxins::context>();
+    parent_ctx->set_variable("x", 2);
+
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->set_variable("y", 3);
+    ctx->inherit_context(parent_ctx);
+
+    fluxins::fluxins_variable *x = ctx->bind_variable("x");
+    fluxins::fluxins_variable *y = ctx->bind_variable("y");
+    REQUIRE(x);
+    REQUIRE(y);
+    CHECK(x == parent_ctx->bind_variable("x"));
+    CHECK_FALSE(ctx->bind_variable("z"));
+
+    // Inserting variables keeps the handles valid
+    for (int i = 0; i < 100; i++)
+    {
+        ctx->set_variable("v" + std::to_string(i), (float) i);
+    }
+    CHECK(y == ctx->bind_variable("y"));
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        CAPTURE(mode);
+
+        fluxins::expression expr("x * 10 + y + z", cfg, ctx);
+        expr.parse();
+        if (mode >= 1) expr.compile();
+        if (mode >= 2) expr.compile_native();
+        expr.bind();
+
+        // Added after binding, unbound variables are still looked up by name
+        ctx->set_variable("z", 0);
+
+        *x = 2;
+        *y = 3;
+        expr.evaluate();
+        CHECK(expr.value == 23.0f);
+
+        // Updated through the handles
+        *x = 5;
+        *y = 1;
+        expr.evaluate();
+        CHECK(expr.value == 51.0f);
+
+        // Also updated by name
+        ctx->set_variable("y", 7);
+        expr.evaluate();
+        CHECK(expr.value == 57.0f);
+
+        ctx->set_variable("z", 100);
+        expr.evaluate();
+        CHECK(expr.value == 157.0f);
+        ctx->variables.erase("z");
+    }
+
+    // Batch prefers columns over bound variables
+    fluxins::expression batch("x * 10 + y", cfg, ctx);
+    batch.parse();
+    batch.compile();
+    batch.bind();
+
+    std::vector<float>           ys      = { 1, 2 };
+    std::vector<fluxins::column> columns = {
+        { "y", ys },
+    };
+    std::vector<float> output(ys.size());
+    batch.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 51, 52 });
+}
+
+TEST_CASE("Variable rebinding")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    for (int mode = 0; mode < 4; mode++)
+    {
+        CAPTURE(mode);
+
+        auto parent_ctx = std::make_shared<fluxins::context>();
+        parent_ctx->set_variable("x", 1);
+
+        auto ctx = std::make_shared<fluxins::context>();
+        ctx->inherit_context(parent_ctx);
+
+        fluxins::expression expr("x + 1", cfg, ctx);
+        if (mode < 3)
+        {
+            expr.parse();
+            if (mode >= 1) expr.compile();
+            if (mode >= 2) expr.compile_native();
+            expr.bind();
+            expr.evaluate();
+        }
+        else
+        {
+            expr.get_value();
+        }
+        CHECK(expr.value == 2.0f);
+
+        // Shadowing variable is read instead
+        ctx->set_variable("x", 10);
+        expr.evaluate();
+        CHECK(expr.value == 11.0f);
+
+        // Removed and inserted again
+        ctx->variables.erase("x");
+        ctx->set_variable("x", 5);
+        expr.evaluate();
+        CHECK(expr.value == 6.0f);
+
+        // Removed, the shadowed variable is read again
+        ctx->variables.erase("x");
+        expr.evaluate();
+        CHECK(expr.value == 2.0f);
+
+        parent_ctx->variables.erase("x");
+        CHECK_THROWS_AS(expr.evaluate(), fluxins::unresolved_reference);
+        CHECK_FALSE(expr.try_evaluate().has_value());
+
+        // Replaced context
+        auto other_ctx = std::make_shared<fluxins::context>();
+        other_ctx->set_variable("x", 20);
+        expr.ctx = other_ctx;
+        expr.evaluate();
+        CHECK(expr.value == 21.0f);
+    }
+}
+
+TEST_CASE("Function binding")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    // Function counting its copies
+    static int copies = 0;
+    struct twice {
+        twice() = default;
+        twice(const twice &) { copies++; }
+
+        float operator()(FLUXINS_FN_PARAMS) const
+        {
+            return params[0] * 2;
+        }
+    };
+
+    ctx->set_function("f", twice {});
+    ctx->set_variable("x", 3);
+
+    const fluxins::fluxins_function *f = ctx->bind_function("f");
+    REQUIRE(f);
+    CHECK_FALSE(ctx->bind_function("g"));
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        CAPTURE(mode);
+
+        ctx->set_function("f", twice {});
+
+        fluxins::expression expr("f(x) + f(1)", cfg, ctx);
+        expr.parse();
+        if (mode >= 1) expr.compile();
+        if (mode >= 2) expr.compile_native();
+        expr.bind();
+
+        copies = 0;
+        expr.evaluate();
+        CHECK(expr.value == 8.0f);
+        CHECK(copies == 0);
+
+        // Redefinition is picked up by the bound calls
+        ctx->set_function("f", [](FLUXINS_FN_PARAMS) { return params[0] * 3; });
+        CHECK(ctx->bind_function("f") == f);
+        expr.evaluate();
+        CHECK(expr.value == 12.0f);
+    }
+}
+
+TEST_CASE("Function rebinding")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    for (int mode = 0; mode < 4; mode++)
+    {
+        CAPTURE(mode);
+
+        auto parent_ctx = std::make_shared<fluxins::context>();
+        parent_ctx->set_function("g", [](FLUXINS_FN_PARAMS) { return 1.0f; });
+
+        auto ctx = std::make_shared<fluxins::context>();
+        ctx->inherit_context(parent_ctx);
+        ctx->set_function("h", [](FLUXINS_FN_PARAMS) { return 10.0f; });
+
+        fluxins::expression expr("g() + h()", cfg, ctx);
+        if (mode < 3)
+        {
+            expr.parse();
+            if (mode >= 1) expr.compile();
+            if (mode >= 2) expr.compile_native();
+            expr.bind();
+            expr.evaluate();
+        }
+        else
+        {
+            expr.get_value();
+        }
+        CHECK(expr.value == 11.0f);
+
+        // Shadowing function is called instead
+        ctx->set_function("g", [](FLUXINS_FN_PARAMS) { return 2.0f; });
+        expr.evaluate();
+        CHECK(expr.value == 12.0f);
+
+        // Removed, the shadowed function is called again
+        ctx->functions.erase("g");
+        ctx->traits.erase("g");
+        expr.evaluate();
+        CHECK(expr.value == 11.0f);
+
+        ctx->functions.erase("h");
+        ctx->traits.erase("h");
+        CHECK_THROWS_AS(expr.evaluate(), fluxins::unresolved_reference);
+        CHECK_FALSE(expr.try_evaluate().has_value());
+    }
+}
@@ -0,0 +1,108 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests the cache of parsed expressions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <memory>
+
+#include "doctest/doctest.h"
+#include "fluxins/cache.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+
+TEST_CASE("Cache hits and misses")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression_cache cache(2);
+
+    auto other = std::make_shared<fluxins::config>();
+
+    auto first = cache.parse("1 + 2", cfg);
+    REQUIRE(first);
+    CHECK(cache.parse("1 + 2", cfg) == first);
+    CHECK(cache.parse("1 + 2", other) != first); // Different config
+
+    auto statistics = cache.statistics();
+    CHECK(statistics.hits == 1);
+    CHECK(statistics.misses == 2);
+    CHECK(statistics.size == 2);
+    CHECK(statistics.capacity == 2);
+
+    // Least recently used expression is evicted
+    CHECK(cache.find("1 + 2", cfg) == first);
+    cache.parse("2 * 3", cfg);
+    CHECK(cache.find("1 + 2", other) == nullptr);
+    CHECK(cache.statistics().evictions == 1);
+    CHECK(cache.find("1 + 2", cfg) == first);
+    cache.parse("3 - 4", cfg);
+    CHECK(cache.find("2 * 3", cfg) == nullptr);
+    CHECK(cache.find("1 + 2", cfg) == first);
+
+    cache.reset_statistics();
+    CHECK(cache.statistics().hits == 0);
+
+    cache.set_capacity(1);
+    CHECK(cache.statistics().size == 1);
+
+    cache.clear();
+    CHECK(cache.statistics().size == 0);
+    CHECK(cache.find("1 + 2", cfg) == nullptr);
+}
+
+TEST_CASE("Cache invalidation by config")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression_cache cache;
+
+    auto before = cache.parse("1 - 2 * 3", cfg);
+    CHECK(before->ast->evaluate("1 - 2 * 3", cfg, nullptr) == -5.0f);
+
+    // Parsed differently with the new precedence
+    cfg->assign_precedence("-", 0, true, true);
+    auto after = cache.parse("1 - 2 * 3", cfg);
+    CHECK(after != before);
+    CHECK(after->ast->evaluate("1 - 2 * 3", cfg, nullptr) == -3.0f);
+
+    // Errors are not cached
+    CHECK_THROWS_AS(cache.parse("1 +", cfg), fluxins::unexpected_token);
+    CHECK(cache.statistics().size == 2);
+
+    auto collected = fluxins::collect_errors([&] { return cache.parse("1 +", cfg); });
+    CHECK_FALSE(collected.has_value());
+    CHECK(cache.statistics().size == 2);
+}
+
+TEST_CASE("Cached expressions are not shared")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto a   = std::make_shared<fluxins::context>();
+    auto b   = std::make_shared<fluxins::context>();
+    a->set_variable("x", 1.0f);
+    b->set_variable("x", 2.0f);
+
+    fluxins::global_cache().clear();
+    fluxins::global_cache().reset_statistics();
+
+    // Each expression binds its own copy of the cached AST
+    fluxins::expression first("x * 10", cfg, a);
+    fluxins::expression second("x * 10", cfg, b);
+    CHECK(first.get_value() == 10.0f);
+    CHECK(second.get_value() == 20.0f);
+
+    CHECK(fluxins::express("x * 10", cfg, a) == 10.0f);
+    CHECK(fluxins::express("x * 10", cfg, b) == 20.0f);
+
+    auto statistics = fluxins::global_cache().statistics();
+    CHECK(statistics.misses == 1);
+    CHECK(statistics.hits == 3);
+}
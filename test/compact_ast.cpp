@@ -0,0 +1,111 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests compact AST against the AST evaluator.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/compact_ast.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
+
+TEST_CASE("Compact AST matches AST evaluation")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+    ctx->set_variable("y", -2.5f);
+    ctx->set_variable("flag", 0);
+
+    std::vector<std::string> expressions = {
+        "",
+        "42",
+        "(1 + 2) * 3 - 4 / 5 + 2 ** (1 + 1)",
+        "-x + +y * *x / /y",
+        "3! + !0 + ~5",
+        "x %% 2 + y % 2 + x // 2",
+        "flag ? x : y",
+        "x ? flag ? 1 : 2 : 3",
+        "max(x, y, 4) + min(x, y) + avg(1, 2, 3)",
+        "sqrt(x * x + y * y) / (1 + sqrt(x * x + y * y))",
+        "x == 3 && y < 0 || flag",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression tree(text, cfg, ctx);
+        tree.parse();
+        tree.evaluate();
+
+        fluxins::compact_ast compacted = fluxins::compact(tree.expr, tree.ast, cfg);
+        CAPTURE(fluxins::compact_ast_to_string(tree.expr, compacted));
+        CHECK(compacted.nodes.size() == compacted.locations.size());
+        CHECK(fluxins::evaluate(compacted, { tree.expr, *cfg, ctx.get() }) == tree.value);
+
+        // Shared subexpressions are stored once
+        tree.optimize();
+        fluxins::compact_ast optimized = fluxins::compact(tree.expr, tree.ast, cfg);
+        CHECK(optimized.nodes.size() <= compacted.nodes.size());
+        CHECK(fluxins::evaluate(optimized, { tree.expr, *cfg, ctx.get() }) == tree.value);
+    }
+}
+
+TEST_CASE("Compact AST layout")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    CHECK(sizeof(fluxins::compact_node) == 12);
+
+    fluxins::expression expr("(a + b) * (a + b) + f(a, 1)", cfg);
+    expr.parse();
+    expr.optimize();
+
+    fluxins::compact_ast tree = fluxins::compact(expr.expr, expr.ast, cfg);
+
+    // a, b, a + b, (a + b) * (a + b), a, 1, f(a, 1), root
+    CHECK(tree.nodes.size() == 8);
+    CHECK(tree.names == std::vector<std::string> { "a", "b", "f" });
+    CHECK(tree.nodes[tree.root()].kind == fluxins::compact_kind::binary);
+    CHECK(tree.shared_nodes.empty());
+
+    const fluxins::compact_node &product = tree.nodes[3];
+    CHECK(product.kind == fluxins::compact_kind::binary);
+    CHECK(tree.children[product.first] == 2);
+    CHECK(tree.children[product.first + 1] == 2);
+}
+
+TEST_CASE("Compact AST errors")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    fluxins::expression expr("1 + x", cfg, ctx);
+    expr.parse();
+
+    fluxins::compact_ast tree = fluxins::compact(expr.expr, expr.ast, cfg);
+    CHECK_THROWS_AS(fluxins::evaluate(tree, { expr.expr, *cfg, ctx.get() }), fluxins::unresolved_reference);
+
+    ctx->set_variable("x", 2);
+    CHECK(fluxins::evaluate(tree, { expr.expr, *cfg, ctx.get() }) == 3.0f);
+
+    fluxins::expression division("1 / 0", cfg);
+    division.parse();
+
+    fluxins::compact_ast divided = fluxins::compact(division.expr, division.ast, cfg);
+    CHECK_THROWS_AS(fluxins::evaluate(divided, { division.expr, *cfg }), fluxins::code_error);
+}
@@ -0,0 +1,168 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests compiled expressions evaluated from multiple threads.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+
+TEST_CASE("Compiled expression variables")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    auto compiled = fluxins::compile_expression("x * y + x + 2 * 3", cfg);
+    REQUIRE(compiled);
+    REQUIRE(compiled->variables.size() == 2);
+    CHECK(compiled->variables[0] == "x");
+    CHECK(compiled->variables[1] == "y");
+    CHECK(compiled->find_variable("y") == 1);
+    CHECK(compiled->find_variable("z") == (std::size_t) -1);
+
+    std::array<float, 2> values = { 2.0f, 5.0f };
+    CHECK(compiled->evaluate(values) == 18.0f);
+
+    values = { 3.0f, 1.0f };
+    CHECK(compiled->evaluate(values) == 12.0f);
+
+    // Variables without values are looked up in the context
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->set_variable("x", 1.0f);
+    ctx->set_variable("y", 4.0f);
+    CHECK(compiled->evaluate(ctx.get()) == 11.0f);
+    CHECK(compiled->evaluate(std::array { 2.0f }, ctx.get()) == 16.0f);
+
+    CHECK_THROWS_AS(compiled->evaluate(nullptr), fluxins::unresolved_reference);
+
+    auto error = compiled->try_evaluate(std::array { 2.0f });
+    REQUIRE_FALSE(error.has_value());
+    CHECK(error.error().kind == fluxins::error_kind::unresolved_reference);
+}
+
+TEST_CASE("Compiled expression functions")
+{
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+
+    auto compiled = fluxins::compile_expression("sqrt(x) + max(x, 2)", nullptr, ctx);
+    REQUIRE(compiled);
+    CHECK(compiled->evaluate(std::array { 9.0f }, ctx.get()) == 12.0f);
+
+    // Functions evaluating compiled expressions on the same thread
+    auto inner = fluxins::compile_expression("x * 2");
+    ctx->set_function("twice", [inner](FLUXINS_FN_PARAMS) {
+        FLUXINS_FN_ARITY("twice", 1);
+        return inner->evaluate(params);
+    });
+
+    auto outer = fluxins::compile_expression("twice(x) + twice(x + 1)", nullptr, ctx);
+    CHECK(outer->evaluate(std::array { 1.0f }, ctx.get()) == 6.0f);
+}
+
+TEST_CASE("Compiled expression from multiple threads")
+{
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+
+    auto compiled = fluxins::compile_expression("sin(x) * sin(x) + cos(x) * cos(x) + x", nullptr, ctx);
+    REQUIRE(compiled);
+
+    constexpr std::size_t threads = 8;
+    constexpr std::size_t rows    = 10000;
+
+    std::vector<std::vector<float>> results(threads, std::vector<float>(rows));
+    std::vector<std::thread>        workers;
+
+    for (std::size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t] {
+            for (std::size_t i = 0; i < rows; i++)
+            {
+                float x       = (float) (t * rows + i);
+                results[t][i] = compiled->evaluate(std::array { x }, ctx.get());
+            }
+        });
+    }
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (std::size_t t = 0; t < threads; t++)
+    {
+        for (std::size_t i = 0; i < rows; i += 997)
+        {
+            float x = (float) (t * rows + i);
+            CHECK(std::abs(results[t][i] - (x + 1.0f)) <= 1e-3f * std::max(1.0f, x));
+        }
+    }
+}
+
+TEST_CASE("Specialized expression")
+{
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+
+    const char *text = "sqrt(gain * gain + 1) * x + (mode ? offset * 2 : -offset) + y / gain";
+
+    auto general = fluxins::compile_expression(text, nullptr, ctx);
+    REQUIRE(general);
+    CHECK(general->variables.size() == 5);
+
+    auto specialized = fluxins::specialize_expression(text, { { "gain", 2.0f }, { "mode", 1.0f }, { "offset", 3.0f } }, nullptr, ctx);
+    REQUIRE(specialized);
+    REQUIRE(specialized->variables.size() == 2);
+    CHECK(specialized->variables[0] == "x");
+    CHECK(specialized->variables[1] == "y");
+    CHECK(specialized->program.instructions.size() < general->program.instructions.size());
+
+    for (float x : { -1.0f, 0.0f, 2.5f })
+    {
+        for (float y : { 0.0f, 4.0f })
+        {
+            std::array<float, 5> values;
+            values[general->find_variable("gain")]   = 2.0f;
+            values[general->find_variable("mode")]   = 1.0f;
+            values[general->find_variable("offset")] = 3.0f;
+            values[general->find_variable("x")]      = x;
+            values[general->find_variable("y")]      = y;
+
+            CHECK(specialized->evaluate(std::array { x, y }, ctx.get()) == general->evaluate(values, ctx.get()));
+        }
+    }
+
+    // Specialized further, keeping the previous constants
+    auto further = specialized->specialize({ { "x", 1.0f } }, ctx);
+    REQUIRE(further);
+    CHECK(further->variables == std::vector<std::string> { "y" });
+    CHECK(further->constants.size() == 4);
+    CHECK(further->evaluate(std::array { 4.0f }, ctx.get()) == specialized->evaluate(std::array { 1.0f, 4.0f }, ctx.get()));
+
+    // Fully specialized expressions are folded into one number
+    auto constant = further->specialize({ { "y", 2.0f } }, ctx);
+    REQUIRE(constant);
+    CHECK(constant->variables.empty());
+    CHECK(constant->program.instructions.size() == 1);
+    CHECK(constant->evaluate(nullptr) == specialized->evaluate(std::array { 1.0f, 2.0f }, ctx.get()));
+
+    // Functions are not folded without a context, and are looked up when evaluated
+    auto failing = fluxins::specialize_expression("sqrt(a) + x", { { "a", 1.0f } });
+    REQUIRE(failing);
+    CHECK_THROWS_AS(failing->evaluate(std::array { 1.0f }), fluxins::unresolved_reference);
+}
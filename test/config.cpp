@@ -378,3 +378,44 @@ TEST_CASE("Custom binary operator")
 
     CHECK_FALSE(cfg->binary_op_exists("+++"));
 }
+
+TEST_CASE("Operator lookup")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    CHECK(cfg->lookup.version == cfg->version);
+
+    // Operators sharing a prefix
+    CHECK(cfg->find_binary_op("*") == 2);
+    CHECK(cfg->find_binary_op("**") == 6);
+    CHECK(cfg->find_binary_op("***") == (std::size_t) -1);
+    CHECK(cfg->find_binary_op("") == (std::size_t) -1);
+    CHECK(cfg->find_binary_op("#") == (std::size_t) -1);
+
+    // Same symbol for different kinds of operators
+    CHECK(cfg->find_unary_prefix_op("!") == 4);
+    CHECK(cfg->find_unary_suffix_op("!") == 0);
+    CHECK(cfg->find_binary_op("!") == (std::size_t) -1);
+    CHECK(cfg->find_binary_op("!!") == 21);
+
+    // Lookup is rebuilt when operators are added or removed
+    cfg->add_binary_op({ "***", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x * y * y; } });
+    CHECK(cfg->lookup.version == cfg->version);
+    CHECK(cfg->find_binary_op("***") == cfg->binary_operators.size() - 1);
+
+    cfg->remove_binary_op("*");
+    CHECK(cfg->find_binary_op("*") == (std::size_t) -1);
+    CHECK(cfg->find_binary_op("**") == 5);
+    CHECK(cfg->find_binary_op("***") == cfg->binary_operators.size() - 1);
+
+    // Lists of operators modified directly are searched until the lookup is
+    // rebuilt
+    cfg->unary_suffix_operators.push_back({ "?!", [](FLUXINS_UOP_PARAMS) { return -x; } });
+    cfg->version++;
+    CHECK(cfg->lookup.version != cfg->version);
+    CHECK(cfg->find_unary_suffix_op("?!") == 1);
+
+    cfg->update_lookup();
+    CHECK(cfg->lookup.version == cfg->version);
+    CHECK(cfg->find_unary_suffix_op("?!") == 1);
+    CHECK(fluxins::express("3?! + 1", cfg) == -2.0f);
+}
@@ -115,3 +115,29 @@ TEST_CASE("Deep inheritance")
     expr.inherit_context(child_ctx);
     CHECK(expr.get_value() == 30.0f);
 }
+
+TEST_CASE("Function traits")
+{
+    auto parent_ctx = std::make_shared<fluxins::context>();
+    parent_ctx->populate();
+
+    CHECK(parent_ctx->resolve_function_traits("sqrt").pure);
+    CHECK(parent_ctx->resolve_function_traits("sqrt").accepts(1));
+    CHECK_FALSE(parent_ctx->resolve_function_traits("sqrt").accepts(2));
+    CHECK(parent_ctx->resolve_function_traits("max").accepts(5));
+    CHECK_FALSE(parent_ctx->resolve_function_traits("max").accepts(0));
+    CHECK_FALSE(parent_ctx->resolve_function_traits("rand").pure);
+    CHECK_FALSE(parent_ctx->resolve_function_traits("srand").pure);
+    CHECK_FALSE(parent_ctx->resolve_function_traits("time").pure);
+
+    // Functions without traits are impure
+    auto child_ctx = std::make_shared<fluxins::context>();
+    child_ctx->inherit_context(parent_ctx);
+    child_ctx->set_function("sqrt", [](FLUXINS_FN_PARAMS) { return params[0]; });
+    child_ctx->set_function("twice", [](FLUXINS_FN_PARAMS) { return params[0] * 2; }, { .pure = true, .min_arity = 1, .max_arity = 1 });
+
+    CHECK_FALSE(child_ctx->resolve_function_traits("sqrt").pure);
+    CHECK(child_ctx->resolve_function_traits("twice").pure);
+    CHECK(child_ctx->resolve_function_traits("cos").pure);
+    CHECK_FALSE(child_ctx->resolve_function_traits("missing").pure);
+}
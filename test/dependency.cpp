@@ -0,0 +1,317 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests recording the variables read by expressions and
+/// evaluating only the expressions whose variables were modified.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
+
+TEST_CASE("Collect symbols")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("x + f(y, x) * (z ? g() : x)", cfg);
+    expr.parse();
+
+    fluxins::ast_symbols symbols;
+    expr.ast->collect_symbols(symbols);
+    CHECK(symbols.variables == std::vector<std::string> { "x", "y", "z" });
+    CHECK(symbols.functions == std::vector<std::string> { "f", "g" });
+}
+
+TEST_CASE("Context revision")
+{
+    auto parent = std::make_shared<fluxins::context>();
+    auto child  = std::make_shared<fluxins::context>();
+
+    std::size_t revision = child->revision();
+    child->inherit_context(parent);
+    CHECK(child->revision() != revision);
+
+    // Assigning an existing variable keeps the revision
+    revision = child->revision();
+    parent->set_variable("x", 1);
+    CHECK(child->revision() != revision);
+    revision = child->revision();
+    parent->set_variable("x", 2);
+    CHECK(child->revision() == revision);
+
+    parent->set_function("f", [](FLUXINS_FN_PARAMS) { return 0.0f; });
+    CHECK(child->revision() != revision);
+}
+
+TEST_CASE("Evaluate only when inputs change")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("width", 100);
+    ctx->set_variable("height", 50);
+
+    // Count the evaluations through a pure function
+    std::size_t calls = 0;
+    ctx->set_function(
+        "count",
+        [&](FLUXINS_FN_PARAMS) {
+            calls++;
+            return params[0];
+        },
+        { .pure = true, .min_arity = 1, .max_arity = 1 });
+
+    fluxins::expression left("count(width / 2)", cfg, ctx);
+    fluxins::expression right("count(height + 10)", cfg, ctx);
+    left.parse();
+    right.parse();
+
+    left.evaluate();
+    right.evaluate();
+    CHECK(left.value == 50.0f);
+    CHECK(right.value == 60.0f);
+    CHECK(calls == 2);
+    CHECK_FALSE(left.outdated());
+    CHECK_FALSE(right.outdated());
+
+    // Nothing changed
+    left.evaluate();
+    right.evaluate();
+    CHECK(calls == 2);
+
+    // Only the expression reading the variable is evaluated again
+    ctx->variables["width"] = 300;
+    CHECK(left.outdated());
+    CHECK_FALSE(right.outdated());
+    left.evaluate();
+    right.evaluate();
+    CHECK(left.value == 150.0f);
+    CHECK(right.value == 60.0f);
+    CHECK(calls == 3);
+
+    // Assigning the same value is not a change
+    ctx->set_variable("height", 50);
+    right.evaluate();
+    CHECK(calls == 3);
+
+    // Bound expressions are tracked the same way
+    left.compile();
+    left.bind();
+    left.evaluate();
+    CHECK(calls == 4);
+    left.evaluate();
+    CHECK(calls == 4);
+    *ctx->bind_variable("width") = 10;
+    left.evaluate();
+    CHECK(left.value == 5.0f);
+    CHECK(calls == 5);
+
+    // Redefining a function changes the revision
+    ctx->set_function("count", [](FLUXINS_FN_PARAMS) { return -params[0]; }, { .pure = true });
+    CHECK(left.outdated());
+    left.evaluate();
+    CHECK(left.value == -5.0f);
+}
+
+TEST_CASE("Evaluate again after structural changes")
+{
+    auto cfg    = std::make_shared<fluxins::config>();
+    auto parent = std::make_shared<fluxins::context>();
+    parent->set_variable("x", 1);
+
+    fluxins::expression expr("x", cfg);
+    expr.inherit_context(parent);
+    expr.parse();
+    expr.evaluate();
+    CHECK(expr.value == 1.0f);
+
+    // Variable in the parent context
+    parent->variables["x"] = 2;
+    expr.evaluate();
+    CHECK(expr.value == 2.0f);
+
+    // Shadowing variable
+    expr.set_variable("x", 3);
+    CHECK(expr.outdated());
+    expr.evaluate();
+    CHECK(expr.value == 3.0f);
+
+    // Parsing again
+    expr.expr = "x * 2";
+    expr.parse();
+    CHECK(expr.outdated());
+    expr.evaluate();
+    CHECK(expr.value == 6.0f);
+
+    // Another context
+    auto other = std::make_shared<fluxins::context>();
+    other->set_variable("x", 10);
+    expr.ctx = other;
+    expr.evaluate();
+    CHECK(expr.value == 20.0f);
+
+    // NaN does not differ from NaN
+    other->variables["x"] = std::numeric_limits<float>::quiet_NaN();
+    expr.evaluate();
+    CHECK(std::isnan(expr.value));
+    CHECK_FALSE(expr.outdated());
+}
+
+TEST_CASE("Evaluate again after structural changes made directly")
+{
+    auto cfg    = std::make_shared<fluxins::config>();
+    auto parent = std::make_shared<fluxins::context>();
+    parent->set_variable("x", 1);
+
+    fluxins::expression expr("x + 1", cfg);
+    expr.inherit_context(parent);
+    expr.parse();
+    expr.evaluate();
+    CHECK(expr.value == 2.0f);
+
+    // Assigning values is not a structural change
+    std::size_t epoch = fluxins::context_epoch();
+    parent->variables["x"] = 2;
+    CHECK(fluxins::context_epoch() == epoch);
+    expr.evaluate();
+    CHECK(expr.value == 3.0f);
+    CHECK(expr.tracked_epoch == epoch);
+
+    // Shadowing variable added through the map
+    expr.ctx->variables["x"] = 5;
+    CHECK(fluxins::context_epoch() != epoch);
+    CHECK(expr.outdated());
+    expr.evaluate();
+    CHECK(expr.value == 6.0f);
+
+    // Shadowing variable removed through the map
+    expr.ctx->variables.erase("x");
+    CHECK(expr.outdated());
+    expr.evaluate();
+    CHECK(expr.value == 3.0f);
+
+    // Unrelated change is noticed, but does not make the expression outdated
+    auto other = std::make_shared<fluxins::context>();
+    other->variables.emplace("y", 1.0f);
+    CHECK(expr.tracked_epoch != fluxins::context_epoch());
+    CHECK_FALSE(expr.outdated());
+    expr.evaluate();
+    CHECK(expr.tracked_epoch == fluxins::context_epoch());
+
+    // Parent replaced directly
+    auto replacement = std::make_shared<fluxins::context>();
+    replacement->set_variable("x", 10);
+    expr.ctx->parents = { replacement };
+    expr.ctx->modified();
+    expr.evaluate();
+    CHECK(expr.value == 11.0f);
+}
+
+TEST_CASE("Optimize again after modifying functions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        CAPTURE(mode);
+
+        auto ctx = std::make_shared<fluxins::context>();
+        ctx->populate();
+        ctx->set_function("f", [](FLUXINS_FN_PARAMS) { return params[0] * 2; }, { .pure = true });
+
+        // Both calls are folded
+        fluxins::expression expr("f(3) + sin(0) + 1", cfg, ctx);
+        if (mode == 0)
+        {
+            expr.get_value();
+        }
+        else
+        {
+            expr.parse();
+            expr.optimize();
+            if (mode == 2) expr.compile_native();
+            expr.bind();
+            expr.evaluate();
+        }
+        CHECK(expr.value == 7.0f);
+
+        // Adding variables does not optimize again
+        const fluxins::ast_node *optimized = expr.ast.get();
+        ctx->set_variable("y", 1);
+        expr.evaluate();
+        CHECK(expr.ast.get() == optimized);
+
+        // Redefined pure function
+        ctx->set_function("f", [](FLUXINS_FN_PARAMS) { return params[0] * 10; }, { .pure = true });
+        CHECK(expr.outdated());
+        expr.evaluate();
+        CHECK(expr.value == 31.0f);
+
+        // Overridden built-in function
+        ctx->set_function("sin", [](FLUXINS_FN_PARAMS) { return 100.0f; }, { .pure = true });
+        expr.evaluate();
+        CHECK(expr.value == 131.0f);
+
+        // Impure function is not folded anymore
+        std::size_t calls = 0;
+        ctx->set_function("f", [&](FLUXINS_FN_PARAMS) { return (float) ++calls; });
+        expr.evaluate();
+        expr.evaluate();
+        CHECK(calls == 2);
+        CHECK(expr.value == 103.0f);
+
+        // Batches use the current functions too
+        std::vector<float> output(2);
+        expr.evaluate_batch({}, output);
+        CHECK(calls == 4);
+    }
+}
+
+TEST_CASE("Impure expressions are always evaluated")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    std::size_t         calls = 0;
+    fluxins::expression expr("next() + x", cfg);
+    expr.set_variable("x", 1);
+    expr.set_function("next", [&](FLUXINS_FN_PARAMS) { return (float) ++calls; });
+    expr.parse();
+
+    expr.evaluate();
+    expr.evaluate();
+    CHECK(calls == 2);
+    CHECK(expr.value == 3.0f);
+    CHECK(expr.outdated());
+}
+
+TEST_CASE("Variables missing from the untaken branch")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("x ? 1 : y", cfg);
+    expr.set_variable("x", 1);
+    expr.parse();
+    expr.evaluate();
+    CHECK(expr.value == 1.0f);
+    CHECK_FALSE(expr.outdated());
+
+    // Adding the variable changes the revision
+    expr.set_variable("y", 5);
+    expr.ctx->variables["x"] = 0;
+    expr.evaluate();
+    CHECK(expr.value == 5.0f);
+}
@@ -4,19 +4,24 @@
 /// @copyright Copyright (c) 2025 Anstro Pleuton
 ///
 /// This test file tests `code_error` exception class and error reporting
-/// mechanisms.
+/// mechanisms, with and without exceptions.
 ///
 /// This project is licensed under the terms of MIT License.
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <cstddef>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "doctest/doctest.h"
 #include "fluxins/config.hpp"
 #include "fluxins/context.hpp"
 #include "fluxins/error.hpp"
 #include "fluxins/expression.hpp"
+#include "fluxins/parser.hpp"
 
 TEST_CASE("Invalid arity")
 {
@@ -67,6 +72,87 @@ TEST_CASE("Unresolved reference to variable")
     CHECK_THROWS_AS(fluxins::express("function(x)", cfg, ctx), fluxins::unresolved_reference);
 }
 
+TEST_CASE("Details of errors")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    ctx->set_function("add", [](FLUXINS_FN_PARAMS) {
+        FLUXINS_FN_ARITY("add", 2);
+        return params[0] + params[1];
+    });
+
+    try
+    {
+        fluxins::express("add(1, 2, 3)", cfg, ctx);
+        FAIL("Expected invalid arity");
+    }
+    catch (const fluxins::invalid_arity &e)
+    {
+        CHECK(e.function == "add");
+        CHECK(e.args_count == 3);
+        CHECK(e.arity == 2);
+    }
+
+    try
+    {
+        fluxins::express("3 + 4 5", cfg, ctx);
+        FAIL("Expected unexpected token");
+    }
+    catch (const fluxins::unexpected_token &e)
+    {
+        REQUIRE(e.unexpected);
+        CHECK(e.unexpected->type == fluxins::token::token_type::number);
+        CHECK(e.unexpected->value == "5");
+        CHECK(e.unexpected->location.begin == 6);
+    }
+
+    try
+    {
+        fluxins::express("1 + x", cfg, ctx);
+        FAIL("Expected unresolved reference");
+    }
+    catch (const fluxins::unresolved_reference &e)
+    {
+        CHECK(e.symbol == "x");
+        CHECK(e.type == "variable");
+    }
+
+    try
+    {
+        fluxins::express("function(1)", cfg, ctx);
+        FAIL("Expected unresolved reference");
+    }
+    catch (const fluxins::unresolved_reference &e)
+    {
+        CHECK(e.symbol == "function");
+        CHECK(e.type == "function");
+    }
+
+    // Same details without exceptions
+    auto arity = fluxins::try_express("add(1)", cfg, ctx);
+    REQUIRE_FALSE(arity.has_value());
+    CHECK(arity.error().symbol == "add");
+    CHECK(arity.error().args_count == 1);
+    CHECK(arity.error().arity == 2);
+
+    auto unresolved = fluxins::try_express("y * 2", cfg, ctx);
+    REQUIRE_FALSE(unresolved.has_value());
+    CHECK(unresolved.error().symbol == "y");
+    CHECK(unresolved.error().symbol_type == "variable");
+
+    // Details are kept when the error is collected from an exception
+    fluxins::code expr("1");
+    auto          thrown = fluxins::collect_errors([&]() -> float {
+        throw fluxins::invalid_arity("sum", 4, 1, expr, { 0, 1, 0 });
+    });
+    REQUIRE_FALSE(thrown.has_value());
+    CHECK(thrown.error().kind == fluxins::error_kind::invalid_arity);
+    CHECK(thrown.error().symbol == "sum");
+    CHECK(thrown.error().args_count == 4);
+    CHECK(thrown.error().arity == 1);
+}
+
 // Special case
 TEST_CASE("Unexpected end of expression")
 {
@@ -111,3 +197,151 @@ TEST_CASE("Configuration changed after parsing")
     CHECK_THROWS_AS(expr2.evaluate(), fluxins::unresolved_reference);
     CHECK_THROWS_AS(expr3.evaluate(), fluxins::unresolved_reference);
 }
+
+TEST_CASE("Error location in multi-line code")
+{
+    fluxins::code expr("1 +\n  2 *\n\n  x", "lines.flx");
+    CHECK_FALSE(expr.lines_split);
+
+    CHECK(expr.get_line_col(0) == std::pair<std::size_t, std::size_t>(1, 0));
+    CHECK(expr.lines_split);
+    CHECK(expr.lines.size() == 4);
+
+    CHECK(expr.get_line_col(2) == std::pair<std::size_t, std::size_t>(1, 2));
+    CHECK(expr.get_line_col(6) == std::pair<std::size_t, std::size_t>(2, 2));
+    CHECK(expr.get_line_col(13) == std::pair<std::size_t, std::size_t>(4, 2));
+    CHECK_THROWS_AS(expr.get_line_col(3), std::out_of_range);  // Line break
+    CHECK_THROWS_AS(expr.get_line_col(14), std::out_of_range); // Past the end
+
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    try
+    {
+        fluxins::expression(expr, cfg, ctx).get_value();
+        FAIL("Expected unresolved reference");
+    }
+    catch (const fluxins::unresolved_reference &e)
+    {
+        CHECK(std::string(e.what()).starts_with("lines.flx: 4:2-4:2: "));
+    }
+}
+
+TEST_CASE("Name of unnamed code")
+{
+    fluxins::code expr("1 + x");
+    CHECK(expr.name.empty());
+
+    try
+    {
+        fluxins::express(expr.expr);
+        FAIL("Expected unresolved reference");
+    }
+    catch (const fluxins::unresolved_reference &e)
+    {
+        // Named when the error is reported
+        CHECK(e.expr.name.ends_with(".flx"));
+        CHECK(std::string(e.what()).starts_with(e.expr.name + ": 1:4-1:4: "));
+    }
+
+    const std::string &name = expr.get_name();
+    CHECK(name.size() == 12);
+    CHECK(expr.get_name() == name);
+
+    fluxins::code named("1 + x", "named.flx");
+    CHECK(named.get_name() == "named.flx");
+}
+
+TEST_CASE("Errors without exceptions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    auto value = fluxins::try_express("1 + 2 * 3", cfg, ctx);
+    REQUIRE(value.has_value());
+    CHECK(*value == 7.0f);
+
+    auto division = fluxins::try_express("1 / (2 - 2)", cfg, ctx);
+    REQUIRE_FALSE(division.has_value());
+    CHECK(division.error().kind == fluxins::error_kind::code_error);
+    CHECK(division.error().message == "Division by zero");
+    CHECK(division.error().location.begin == 2);
+
+    auto unresolved = fluxins::try_express("1 + x", cfg, ctx);
+    REQUIRE_FALSE(unresolved.has_value());
+    CHECK(unresolved.error().kind == fluxins::error_kind::unresolved_reference);
+    CHECK(unresolved.error().location.begin == 4);
+
+    auto tokenizer = fluxins::try_express("1 # 2", cfg, ctx);
+    REQUIRE_FALSE(tokenizer.has_value());
+    CHECK(tokenizer.error().kind == fluxins::error_kind::tokenizer_error);
+
+    fluxins::code expr("1 + (2 * 3", "parse.flx");
+    auto          tokens = fluxins::try_tokenize(expr);
+    REQUIRE(tokens.has_value());
+
+    auto ast = fluxins::try_parse(expr, *tokens, cfg);
+    REQUIRE_FALSE(ast.has_value());
+    CHECK(ast.error().kind == fluxins::error_kind::unexpected_token);
+    CHECK(ast.error().format(expr).starts_with("parse.flx: 1:"));
+
+    // Same error is thrown without the non-throwing functions
+    CHECK_THROWS_AS(fluxins::express("1 + (2 * 3", cfg, ctx), fluxins::unexpected_token);
+    CHECK_THROWS_AS(fluxins::express("1 / 0", cfg, ctx), fluxins::code_error);
+}
+
+TEST_CASE("Errors of expression without exceptions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    fluxins::expression expr("1 + x", cfg, ctx);
+    auto                error = expr.try_get_value();
+    REQUIRE_FALSE(error.has_value());
+    CHECK(error.error().kind == fluxins::error_kind::unresolved_reference);
+    CHECK_FALSE(expr.ast);
+
+    ctx->set_variable("x", 2.0f);
+    auto value = expr.try_get_value();
+    REQUIRE(value.has_value());
+    CHECK(*value == 3.0f);
+
+    // Cached value is kept when evaluation fails
+    fluxins::expression division("1 / x", cfg, ctx);
+    CHECK(division.get_value() == 0.5f);
+
+    ctx->set_variable("x", 0.0f);
+    CHECK_FALSE(division.try_evaluate().has_value());
+    CHECK(division.value == 0.5f);
+}
+
+TEST_CASE("Nested error sinks")
+{
+    fluxins::code expr("x");
+
+    auto outer = fluxins::collect_errors([&] {
+        auto inner = fluxins::collect_errors([&] {
+            return fluxins::report_error({ .message = "Inner error" }, expr);
+        });
+        CHECK_FALSE(inner.has_value());
+        CHECK(inner.error().message == "Inner error");
+
+        // Only the first error is collected
+        fluxins::report_error({ .message = "Outer error" }, expr);
+        fluxins::report_error({ .message = "Ignored error" }, expr);
+        return 0.0f;
+    });
+
+    REQUIRE_FALSE(outer.has_value());
+    CHECK(outer.error().message == "Outer error");
+    CHECK(fluxins::error_sink::active() == nullptr);
+
+    // Functions that throw are collected too
+    auto thrown = fluxins::collect_errors([&]() -> float {
+        throw fluxins::code_error("Thrown error", expr, { 0, 1, 0 });
+    });
+    REQUIRE_FALSE(thrown.has_value());
+    CHECK(thrown.error().message == "Thrown error");
+
+    CHECK_THROWS_AS(fluxins::report_error({ .message = "Thrown error" }, expr), fluxins::code_error);
+}
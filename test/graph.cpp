@@ -0,0 +1,184 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests the graph of named expressions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <atomic>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "doctest/doctest.h"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/graph.hpp"
+#include "fluxins/parallel.hpp"
+
+TEST_CASE("Graph levels")
+{
+    fluxins::expression_graph graph;
+    graph.set_input("width", 100);
+
+    // Nodes can be set before the nodes they read
+    graph.set_node("child", "parent / 2");
+    CHECK(graph.find_node("child")->level == 0);
+
+    graph.set_node("parent", "width - 20");
+    graph.set_node("grandchild", "child + parent");
+    CHECK(graph.find_node("parent")->level == 0);
+    CHECK(graph.find_node("child")->level == 1);
+    CHECK(graph.find_node("grandchild")->level == 2);
+
+    CHECK(graph.evaluate() == 3);
+    CHECK(graph.get_value("parent") == 80.0f);
+    CHECK(graph.get_value("child") == 40.0f);
+    CHECK(graph.get_value("grandchild") == 120.0f);
+
+    // Levels of the nodes downstream are updated
+    graph.set_input("offset", 5);
+    graph.set_node("base", "width + offset");
+    graph.set_node("parent", "base * 2");
+    CHECK(graph.find_node("parent")->level == 1);
+    CHECK(graph.find_node("child")->level == 2);
+    CHECK(graph.find_node("grandchild")->level == 3);
+
+    graph.evaluate();
+    CHECK(graph.get_value("parent") == 210.0f);
+    CHECK(graph.get_value("grandchild") == 315.0f);
+
+    // Readers of the removed node read the input of the same name
+    graph.remove_node("parent");
+    CHECK(graph.find_node("child")->level == 0);
+    CHECK(graph.find_node("grandchild")->level == 1);
+    CHECK_THROWS_AS(graph.evaluate(), fluxins::unresolved_reference);
+
+    graph.set_input("parent", 10);
+    graph.evaluate();
+    CHECK(graph.get_value("child") == 5.0f);
+    CHECK(graph.get_value("grandchild") == 15.0f);
+
+    CHECK_THROWS_AS(graph.get_value("parent"), std::invalid_argument);
+    CHECK_THROWS_AS(graph.remove_node("parent"), std::invalid_argument);
+    CHECK_THROWS_AS(graph.set_input("child", 1), std::logic_error);
+}
+
+TEST_CASE("Graph cycles")
+{
+    fluxins::expression_graph graph;
+
+    graph.set_node("a", "b + 1");
+    graph.set_node("b", "c + 1");
+    CHECK_THROWS_AS(graph.set_node("c", "a + 1"), std::logic_error);
+    CHECK_THROWS_AS(graph.set_node("d", "d + 1"), std::logic_error);
+    CHECK_THROWS_AS(graph.set_node("b", "a * 2"), std::logic_error);
+
+    // Graph is left unchanged
+    CHECK_FALSE(graph.find_node("c"));
+    CHECK_FALSE(graph.find_node("d"));
+    CHECK(graph.find_node("b")->inputs.empty());
+    CHECK(graph.find_node("b")->outputs.size() == 1);
+
+    graph.set_input("c", 1);
+    graph.evaluate();
+    CHECK(graph.get_value("a") == 3.0f);
+
+    // Syntax errors leave the graph unchanged as well
+    CHECK_THROWS_AS(graph.set_node("a", "b +"), fluxins::code_error);
+    graph.set_input("c", 2);
+    graph.evaluate();
+    CHECK(graph.get_value("a") == 4.0f);
+}
+
+TEST_CASE("Graph evaluates only downstream nodes")
+{
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->set_variable("x", 1);
+    ctx->set_variable("y", 2);
+
+    std::atomic<std::size_t> calls = 0;
+    ctx->set_function(
+        "count",
+        [&](FLUXINS_FN_PARAMS) {
+            calls++;
+            return params[0];
+        },
+        { .pure = true, .min_arity = 1, .max_arity = 1 });
+
+    fluxins::expression_graph graph(nullptr, ctx);
+    graph.set_node("from_x", "count(x * 10)");
+    graph.set_node("from_y", "count(y * 10)");
+    graph.set_node("from_x_2", "count(from_x + 1)");
+    graph.set_node("both", "count(from_x_2 + from_y)");
+
+    CHECK(graph.evaluate() == 4);
+    CHECK(graph.get_value("both") == 31.0f);
+    CHECK(calls == 4);
+
+    CHECK(graph.evaluate() == 0);
+    CHECK(calls == 4);
+
+    graph.set_input("y", 3);
+    CHECK(graph.evaluate() == 2);
+    CHECK(graph.get_value("both") == 41.0f);
+    CHECK(calls == 6);
+
+    // Downstream nodes whose inputs keep their values are skipped
+    graph.set_node("from_x", "count(x * 5 + 5)");
+    CHECK(graph.evaluate() == 1);
+    CHECK(calls == 7);
+}
+
+TEST_CASE("Graph evaluation is independent of the pool")
+{
+    for (std::size_t threads : { 1, 2, 4 })
+    {
+        fluxins::thread_pool      pool({ .threads = threads, .chunk_size = 1 });
+        fluxins::expression_graph graph;
+        graph.set_input("seed", 1);
+
+        // Wide levels, each node reading two nodes of the previous level
+        for (std::size_t level = 0; level < 5; level++)
+        {
+            for (std::size_t i = 0; i < 20; i++)
+            {
+                std::string name = std::format("n{}_{}", level, i);
+                if (level == 0)
+                {
+                    graph.set_node(name, std::format("seed + {}", i));
+                }
+                else
+                {
+                    graph.set_node(name, std::format("n{}_{} * 0.5 + n{}_{}", level - 1, i, level - 1, (i + 1) % 20));
+                }
+            }
+        }
+
+        CHECK(graph.levels.empty());
+        CHECK(graph.evaluate(pool) == 100);
+        CHECK(graph.levels.size() == 5);
+
+        float expected = 0.0f;
+        {
+            fluxins::expression_graph serial;
+            serial.set_input("seed", 1);
+            serial.set_node("a", "seed + 0");
+            serial.set_node("b", "seed + 1");
+            serial.set_node("c", "a * 0.5 + b");
+            serial.evaluate();
+            expected = serial.get_value("c");
+        }
+        CHECK(graph.get_value("n1_0") == expected);
+
+        graph.set_input("seed", 2);
+        CHECK(graph.evaluate(pool) == 100);
+        CHECK(graph.get_value("n0_19") == 21.0f);
+    }
+}
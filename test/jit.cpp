@@ -0,0 +1,253 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests native compilation against the AST evaluator.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/bytecode.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/jit.hpp"
+
+TEST_CASE("Native code matches AST evaluation")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+    ctx->set_variable("y", -2.5f);
+    ctx->set_variable("z", 0);
+    ctx->set_variable("nan", std::numeric_limits<float>::quiet_NaN());
+
+    std::vector<std::string> expressions = {
+        "",
+        "42",
+        "1 + 2 * 3 - 4 / 5",
+        "-x + +y * *x / /y",
+        "-z + +z",
+        "!x + !z + !nan",
+        "3! + ~5",
+        "x ** 2 ** 0.5 + y ** 2",
+        "x %% 2 + y % 2 + x // 2",
+        "x <? y >? 0 !! 1",
+        "nan <? 1 + (nan >? 2)",
+        "z ?? x",
+        "(x == 3) + (x != 3) + (x < y) + (x > y) + (x <= 3) + (x >= 4)",
+        "(nan == nan) + (nan != nan) + (nan < 1) + (nan > 1) + (nan <= 1) + (nan >= 1)",
+        "x && y + (z && x) + (z || y) + (z || z) + (nan && nan)",
+        "z ? x : y",
+        "nan ? x : y",
+        "x ? z ? 1 : 2 : 3",
+        "(x > y ? x : y) * (z ? 10 : 20)",
+        "z ? 1 / z : 5",
+        "max(x, y, 4) + min(x, y) + avg(1, 2, 3)",
+        "sqrt(x * x + y * y) / (1 + sqrt(x * x + y * y))",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression tree(text, cfg, ctx);
+        tree.parse();
+        tree.evaluate();
+
+        fluxins::expression native(text, cfg, ctx);
+        native.parse();
+        native.compile_native();
+        CHECK((native.native != nullptr) == fluxins::jit_supported());
+        native.evaluate();
+
+        if (std::isnan(tree.value))
+        {
+            CHECK(std::isnan(native.value));
+        }
+        else
+        {
+            CHECK(native.value == tree.value);
+        }
+    }
+}
+
+TEST_CASE("Native code with custom operators")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    cfg->add_unary_prefix_op({ "++", [](FLUXINS_UOP_PARAMS) { return x + 1.0f; } });
+    cfg->add_unary_suffix_op({ "--", [](FLUXINS_UOP_PARAMS) { return x - 1.0f; } });
+    cfg->add_binary_op({ "+++", fluxins::associativity::right, [](FLUXINS_BOP_PARAMS) { return 2.0f * x * y; } });
+    cfg->assign_precedence("+++", 0zu);
+
+    // Replaced built-in operator is called instead of lowered
+    cfg->get_binary_op("+").operate = [](FLUXINS_BOP_PARAMS) { return x + y + 100.0f; };
+
+    fluxins::expression expr("++2 +++ 3-- + 1", cfg);
+    expr.parse();
+    expr.compile_native();
+    expr.evaluate();
+    CHECK(expr.value == 6.0f * 2.0f + 1.0f + 100.0f);
+}
+
+TEST_CASE("Native code re-evaluation with modified context")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("x * 2 + double(x)", cfg);
+    expr.set_variable("x", 1);
+    expr.set_function("double", [](FLUXINS_FN_PARAMS) { return params[0] * 2; });
+    expr.parse();
+    expr.compile_native();
+
+    expr.evaluate();
+    CHECK(expr.value == 4.0f);
+
+    expr.ctx->variables["x"] = 5;
+    expr.evaluate();
+    CHECK(expr.value == 20.0f);
+}
+
+TEST_CASE("Native code deep stack")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    std::string deep = "1";
+    for (int i = 0; i < 50; i++)
+    {
+        deep = "1 + (" + deep + " * 1)";
+    }
+
+    fluxins::expression expr(deep, cfg);
+    expr.parse();
+    expr.compile_native();
+    expr.evaluate();
+    CHECK(expr.value == 51.0f);
+}
+
+TEST_CASE("Native code errors")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    ctx->set_function("add", [](FLUXINS_FN_PARAMS) {
+        FLUXINS_FN_ARITY("add", 2);
+        return params[0] + params[1];
+    });
+
+    auto native = [&](const std::string &text) {
+        fluxins::expression expr(text, cfg, ctx);
+        expr.parse();
+        expr.compile_native();
+        expr.evaluate();
+        return expr.value;
+    };
+
+    CHECK_THROWS_AS(native("x + 1"), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(native("function(1)"), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(native("add(1)"), fluxins::invalid_arity);
+    CHECK_THROWS_AS(native("1 / 0"), fluxins::code_error);
+    CHECK_THROWS_AS(native("/0"), fluxins::code_error);
+    CHECK_THROWS_AS(native("1 + 2 / (3 - 3)"), fluxins::code_error);
+    CHECK(native("1 ? 1 : 1 / 0") == 1.0f);
+    CHECK(native("add(1, 2) / 3") == 1.0f);
+}
+
+TEST_CASE("Native code without context")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    auto native = [&](const std::string &text) {
+        fluxins::expression expr(text, cfg);
+        expr.parse();
+        expr.compile();
+
+        auto compiled = fluxins::jit_compile(expr.program, cfg);
+        if (!compiled)
+        {
+            return fluxins::execute(expr.program, expr.expr, cfg, nullptr);
+        }
+        return fluxins::jit_execute(*compiled, expr.program, expr.expr, cfg, nullptr);
+    };
+
+    CHECK(native("1 + 2") == 3.0f);
+    CHECK_THROWS_AS(native("x + 1"), fluxins::unresolved_reference);
+    CHECK_THROWS_AS(native("function(1)"), fluxins::unresolved_reference);
+
+    auto error = fluxins::collect_errors([&] { return native("2 * y"); });
+    REQUIRE_FALSE(error.has_value());
+    CHECK(error.error().kind == fluxins::error_kind::unresolved_reference);
+    CHECK(error.error().symbol == "y");
+}
+
+TEST_CASE("Native code with modified config")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->set_variable("x", 2);
+
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+    cfg->add_binary_op({ "***", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x * y; } });
+    cfg->assign_precedence("+++", 0zu);
+    cfg->assign_precedence("***", 0zu);
+
+    fluxins::expression expr("x *** 3", cfg, ctx);
+    expr.parse();
+    expr.compile_native();
+    expr.evaluate();
+    CHECK(expr.value == 6.0f);
+
+    // Index of the operator changes, the expression is compiled again
+    cfg->remove_binary_op("+++");
+    expr.evaluate();
+    CHECK(expr.value == 6.0f);
+    CHECK((expr.native != nullptr) == fluxins::jit_supported());
+
+    if (expr.native)
+    {
+        // Stale native code is not executed
+        cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x + y; } });
+        CHECK_THROWS_AS(fluxins::jit_execute(*expr.native, expr.program, expr.expr, cfg, ctx), fluxins::code_error);
+    }
+}
+
+TEST_CASE("Native code with replaced built-in operators")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->set_variable("x", 2);
+
+    fluxins::expression expr("-x + 1", cfg, ctx);
+    expr.parse();
+    expr.compile_native();
+    expr.evaluate();
+    CHECK(expr.value == -1.0f);
+
+    // Replaced through the reference, the expression is compiled again
+    cfg->get_binary_op("+").operate       = [](FLUXINS_BOP_PARAMS) { return x * 100 + y; };
+    cfg->get_unary_prefix_op("-").operate = [](FLUXINS_UOP_PARAMS) { return x * 10; };
+    CHECK(cfg->binary_operators[cfg->find_binary_op("+")].builtin == fluxins::intrinsic::none);
+    CHECK(cfg->unary_prefix_operators[cfg->find_unary_prefix_op("-")].builtin == fluxins::intrinsic::none);
+    expr.evaluate();
+    CHECK(expr.value == 2001.0f);
+    CHECK(expr.value == fluxins::express("-x + 1", cfg, ctx));
+
+    fluxins::expression fresh("1 + 2", cfg);
+    fresh.parse();
+    fresh.compile_native();
+    fresh.evaluate();
+    CHECK(fresh.value == 102.0f);
+    CHECK(fresh.value == fluxins::express("1 + 2", cfg));
+}
@@ -14,6 +14,7 @@
 #include <format>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "doctest/doctest.h"
 #include "fluxins/config.hpp"
@@ -235,3 +236,87 @@ TEST_CASE("Nested ternary operator")
     CHECK(fluxins::express("0 ? 1 ? a : b : 1 ? c : d", cfg, ctx) == 3.0f);
     CHECK(fluxins::express("1 ? 1 ? a : b : 1 ? c : d", cfg, ctx) == 1.0f);
 }
+
+TEST_CASE("Operators resolved at parse time")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    cfg->add_unary_prefix_op({ "++", [](FLUXINS_UOP_PARAMS) { return x + 1.0f; } });
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [](FLUXINS_BOP_PARAMS) { return x * 10 + y; } });
+    cfg->assign_precedence("+++", 0zu);
+
+    fluxins::expression expr("++1 +++ 2 * 3", cfg);
+    expr.parse();
+
+    auto op = std::dynamic_pointer_cast<fluxins::operator_ast>(expr.ast);
+    REQUIRE(op);
+    CHECK(op->index == cfg->find_binary_op("*"));
+    CHECK(op->resolved_config == cfg.get());
+    CHECK(op->resolved_version == cfg->version);
+
+    expr.evaluate();
+    CHECK(expr.value == 66.0f);
+
+    // Removing operators shifts the indices, operators are found by symbol
+    std::size_t version = cfg->version;
+    cfg->remove_unary_prefix_op("-");
+    cfg->remove_binary_op("+");
+    CHECK(cfg->version != version);
+    CHECK(op->find(*cfg) == cfg->find_binary_op("*"));
+
+    expr.evaluate();
+    CHECK(expr.value == 66.0f);
+    expr.compile();
+    expr.evaluate();
+    CHECK(expr.value == 66.0f);
+}
+
+TEST_CASE("Operators parsed by precedence climbing")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    cfg->add_binary_op({ "+++", fluxins::associativity::right, [](FLUXINS_BOP_PARAMS) { return x * 10 + y; } });
+    cfg->assign_precedence("+++", cfg->get_precedence("+"));
+
+    auto binding = [&](std::string_view symbol) { return cfg->binary_op_bindings[cfg->find_binary_op(symbol)]; };
+
+    CHECK(binding("*").power > binding("+").power);
+    CHECK(binding("+++").power == binding("+").power);
+
+    // Left and right associative operators in the same precedence level
+    CHECK_EXPR("1 +++ (2 +++ 3)", "1 +++ 2 +++ 3");
+    CHECK_EXPR("(1 - 2) +++ 3", "1 - 2 +++ 3");
+    CHECK_EXPR("1 +++ (2 - 3)", "1 +++ 2 - 3");
+    CHECK_EXPR("1 +++ (2 * 3 - 4) < 5", "1 +++ 2 * 3 - 4 < 5");
+
+    // Most precedent operators are never right associative
+    cfg->assign_precedence("+++", 0zu, false, true);
+    CHECK_EXPR("(1 +++ 2) +++ 3", "1 +++ 2 +++ 3");
+
+    // Operators without precedence are not parsed
+    cfg->unassign_precedence("+++");
+    CHECK(binding("+++").power == 0);
+    CHECK_THROWS_AS(fluxins::express("1 +++ 2", cfg), fluxins::unexpected_token);
+
+    // Removing an operator removes its precedence
+    cfg->remove_binary_op("+");
+    CHECK(fluxins::express("2 * 3 - 4", cfg) == 2.0f);
+    CHECK_THROWS_AS(fluxins::express("1 + 2", cfg), fluxins::unexpected_token);
+}
+
+TEST_CASE("Associativity modified in-place")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    CHECK(fluxins::express("8 - 4 - 2", cfg) == 2.0f);
+
+    // Cached expression is not used anymore
+    std::size_t version = cfg->version;
+    cfg->get_binary_op("-").assoc = fluxins::associativity::right;
+    CHECK(cfg->version != version);
+    CHECK(fluxins::express("8 - 4 - 2", cfg) == 6.0f);
+    CHECK_EXPR("8 - (4 - 2)", "8 - 4 - 2");
+
+    fluxins::expression expr("8 - 4 - 2", cfg);
+    CHECK(expr.get_value() == 6.0f);
+
+    cfg->get_binary_op("-").assoc = fluxins::associativity::left;
+    CHECK(fluxins::express("8 - 4 - 2", cfg) == 2.0f);
+}
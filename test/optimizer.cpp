@@ -0,0 +1,315 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests optimization passes over AST.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/optimizer.hpp"
+#include "fluxins/parser.hpp"
+
+TEST_CASE("Constant folding")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    auto folded = [&](const std::string &text) {
+        fluxins::expression expr(text, cfg);
+        expr.parse();
+        expr.optimize();
+        return expr.ast;
+    };
+
+    auto number = [&](const std::string &text) {
+        auto node = std::dynamic_pointer_cast<fluxins::number_ast>(folded(text));
+        REQUIRE(node);
+        return node->value;
+    };
+
+    CHECK(number("1 + 2 * 3") == 7.0f);
+    CHECK(number("-(1 / 4) * 2") == -0.5f);
+    CHECK(number("3! + ~5") == 6.0f + ~5);
+    CHECK(number("1 ? 2 : x") == 2.0f);
+    CHECK(number("0 ? x : 1 + 1") == 2.0f);
+    CHECK(number("1 - 1 ? y : (2 > 1 ? 3 : z)") == 3.0f);
+
+    // Partially constant expressions keep the variable parts
+    auto op = std::dynamic_pointer_cast<fluxins::operator_ast>(folded("2 * 3 * x"));
+    REQUIRE(op);
+    CHECK(std::dynamic_pointer_cast<fluxins::number_ast>(op->left));
+    CHECK(std::dynamic_pointer_cast<fluxins::variable_ast>(op->right));
+
+    auto fn = std::dynamic_pointer_cast<fluxins::function_ast>(folded("f(1 + 1, x)"));
+    REQUIRE(fn);
+    CHECK(std::dynamic_pointer_cast<fluxins::number_ast>(fn->args[0]));
+
+    auto cond = std::dynamic_pointer_cast<fluxins::conditional_ast>(folded("x ? 1 + 1 : 2 * 2"));
+    REQUIRE(cond);
+    CHECK(std::dynamic_pointer_cast<fluxins::number_ast>(cond->true_value));
+    CHECK(std::dynamic_pointer_cast<fluxins::number_ast>(cond->false_value));
+}
+
+TEST_CASE("Constant folding leaves errors for evaluation")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("x + 1 / 0", cfg);
+    expr.set_variable("x", 1);
+    expr.parse();
+    expr.optimize();
+    CHECK_FALSE(std::dynamic_pointer_cast<fluxins::number_ast>(expr.ast));
+    CHECK_THROWS_AS(expr.evaluate(), fluxins::code_error);
+
+    // Dead branch would throw, but it is never evaluated
+    CHECK(fluxins::express("1 ? 2 : 1 / 0", cfg) == 2.0f);
+    CHECK_THROWS_AS(fluxins::express("1 / (2 - 2)", cfg), fluxins::code_error);
+    CHECK_THROWS_AS(fluxins::express("0 ? 1 : x", cfg), fluxins::unresolved_reference);
+}
+
+TEST_CASE("Constant folding preserves values")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("x", 3);
+
+    std::vector<std::string> expressions = {
+        "2 * pi * x",
+        "(1 / 3) ** 2 * x",
+        "x %% 2 + 7 // 2 + 5 % 3",
+        "(1 == 1) + (1 != 1) + (1 < 2) + (2 >= 3) + (0 && 1) + (0 || 2)",
+        "1 <? 2 >? 0 !! 1 + (0 ?? 4)",
+        "sqrt(2 + 2) * (x > 2 ? 10 + 1 : 20)",
+        "1 ? 0 ? 1 : 2 : 3",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression plain(text, cfg, ctx);
+        plain.parse();
+        plain.evaluate();
+
+        fluxins::expression optimized(text, cfg, ctx);
+        optimized.parse();
+        optimized.optimize();
+        optimized.evaluate();
+
+        CHECK(optimized.value == plain.value);
+    }
+}
+
+TEST_CASE("Constant folding of pure functions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+
+    // Function counting its calls
+    int calls = 0;
+    ctx->set_function("twice", [&](FLUXINS_FN_PARAMS) { calls++; return params[0] * 2; }, { .pure = true, .min_arity = 1, .max_arity = 1 });
+    ctx->set_function("count", [&](FLUXINS_FN_PARAMS) { calls++; return params[0] * 2; });
+
+    auto folded = [&](const std::string &text) {
+        fluxins::expression expr(text, cfg, ctx);
+        expr.parse();
+        expr.optimize();
+        return expr.ast;
+    };
+
+    auto number = [&](const std::string &text) {
+        auto node = std::dynamic_pointer_cast<fluxins::number_ast>(folded(text));
+        REQUIRE(node);
+        return node->value;
+    };
+
+    CHECK(number("sqrt(16) + max(1, 5, 3)") == 9.0f);
+    CHECK(number("twice(twice(1 + 1))") == 8.0f);
+
+    // Impure, non-constant, invalid arity and throwing calls are kept
+    CHECK(std::dynamic_pointer_cast<fluxins::function_ast>(folded("rand()")));
+    CHECK(std::dynamic_pointer_cast<fluxins::function_ast>(folded("count(1)")));
+    CHECK(std::dynamic_pointer_cast<fluxins::function_ast>(folded("twice(1, 2)")));
+    CHECK(std::dynamic_pointer_cast<fluxins::function_ast>(folded("sqrt(1, 2)")));
+    CHECK(std::dynamic_pointer_cast<fluxins::operator_ast>(folded("sqrt(x) + 1")));
+
+    // Pure calls are shared as well
+    ctx->set_variable("x", 3);
+    fluxins::expression expr("twice(x) * twice(x) + count(x) + count(x)", cfg, ctx);
+    expr.parse();
+    expr.optimize();
+    expr.compile();
+
+    calls = 0;
+    expr.evaluate();
+    CHECK(expr.value == 48.0f);
+    CHECK(calls == 3);
+
+    // Without context, functions are not folded
+    fluxins::expression plain("twice(2)", cfg, ctx);
+    plain.parse();
+    CHECK(std::dynamic_pointer_cast<fluxins::function_ast>(fluxins::fold_constants(plain.expr, plain.ast, cfg)));
+}
+
+TEST_CASE("Substituting variables")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("a * x + (b ? a : y)", cfg);
+    expr.parse();
+
+    auto ast = fluxins::substitute_variables(expr.ast, { { "a", 2.0f }, { "b", 0.0f } });
+    ast      = fluxins::fold_constants(expr.expr, ast, cfg);
+
+    fluxins::ast_symbols symbols;
+    ast->collect_symbols(symbols);
+    CHECK(symbols.variables == std::vector<std::string> { "x", "y" });
+
+    // Substituted variable alone
+    expr.expr = "a";
+    expr.parse();
+    auto number = std::dynamic_pointer_cast<fluxins::number_ast>(fluxins::substitute_variables(expr.ast, { { "a", 5.0f } }));
+    REQUIRE(number);
+    CHECK(number->value == 5.0f);
+}
+
+TEST_CASE("Structural hashing")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    auto parsed = [&](const std::string &text) {
+        fluxins::expression expr(text, cfg);
+        expr.parse();
+        return expr.ast;
+    };
+
+    CHECK(parsed("a * (b + 1)")->equals(*parsed("a*(b+1)")));
+    CHECK(parsed("a * (b + 1)")->hash() == parsed("a*(b+1)")->hash());
+    CHECK(parsed("f(x, 2) ? -y : y!")->equals(*parsed("f(x,2) ? -y:y!")));
+
+    CHECK_FALSE(parsed("a * (b + 1)")->equals(*parsed("a * (b + 2)")));
+    CHECK_FALSE(parsed("a * b")->equals(*parsed("b * a")));
+    CHECK_FALSE(parsed("f(x)")->equals(*parsed("g(x)")));
+    CHECK_FALSE(parsed("f(x)")->equals(*parsed("f(x, x)")));
+    CHECK_FALSE(parsed("x")->equals(*parsed("1")));
+}
+
+TEST_CASE("Common subexpression elimination")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+
+    // Operator counting its calls
+    int calls = 0;
+    cfg->add_binary_op({ "+++", fluxins::associativity::left, [&](FLUXINS_BOP_PARAMS) { calls++; return x * 10 + y; } });
+    cfg->assign_precedence("+++", 0zu);
+
+    ctx->set_variable("x", 2);
+    ctx->set_variable("y", 3);
+    ctx->set_function("f", [&](FLUXINS_FN_PARAMS) { calls++; return params[0]; });
+
+    auto evaluate = [&](const std::string &text, bool native) {
+        fluxins::expression expr(text, cfg, ctx);
+        expr.parse();
+        expr.optimize();
+        if (native) expr.compile_native();
+        else expr.compile();
+
+        calls = 0;
+        expr.evaluate();
+        return expr.value;
+    };
+
+    for (bool native : { false, true })
+    {
+        CAPTURE(native);
+
+        CHECK(evaluate("(x +++ y) + (x +++ y) * (x +++ y)", native) == 23.0f + 23.0f * 23.0f);
+        CHECK(calls == 1);
+
+        // Nested shared subexpressions
+        CHECK(evaluate("((x +++ y) +++ 1) - ((x +++ y) +++ 1) + (x +++ y)", native) == 23.0f);
+        CHECK(calls == 2);
+
+        // Functions are not shared
+        CHECK(evaluate("f(x +++ y) + f(x +++ y)", native) == 46.0f);
+        CHECK(calls == 3);
+
+        // Computed before the conditional, shared by both branches
+        CHECK(evaluate("(x +++ y) + (x ? x +++ y : x +++ y)", native) == 46.0f);
+        CHECK(calls == 1);
+
+        // Computed in one branch only, the other branch computes it again
+        CHECK(evaluate("(x ? x +++ y : 0) + (x +++ y)", native) == 46.0f);
+        CHECK(calls == 2);
+        CHECK(evaluate("(0 ? x +++ y : 1) + (x +++ y)", native) == 24.0f);
+        CHECK(calls == 1);
+        CHECK(evaluate("(y - 3 ? x +++ y : 1) + (x +++ y) * (x +++ y)", native) == 1.0f + 23.0f * 23.0f);
+        CHECK(calls == 1);
+    }
+
+    // Batch evaluates shared subexpression once per block
+    fluxins::expression batch("(x +++ y) / (x +++ y) + (x > 2 ? x +++ y : 0)", cfg, ctx);
+    batch.parse();
+    batch.optimize();
+
+    std::vector<float>           xs = { 1, 2, 3, 4 };
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+    std::vector<float> output(xs.size());
+    batch.evaluate_batch(columns, output);
+    CHECK(output == std::vector<float> { 1, 1, 34, 44 });
+}
+
+TEST_CASE("Common subexpression elimination preserves values")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("a", 3);
+    ctx->set_variable("b", 4);
+
+    std::vector<std::string> expressions = {
+        "sqrt(a*a + b*b) / (1 + sqrt(a*a + b*b))",
+        "(a + b) * (a + b) - (a - b) * (a - b)",
+        "a > b ? (a - b) ** 2 : (b - a) ** 2 + (a - b) ** 2",
+        "-(a * b) + -(a * b) + (a * b)!",
+        "(a ? b : a) + (a ? b : a) * 2",
+    };
+
+    for (const auto &text : expressions)
+    {
+        CAPTURE(text);
+
+        fluxins::expression plain(text, cfg, ctx);
+        plain.parse();
+        plain.evaluate();
+
+        fluxins::expression optimized(text, cfg, ctx);
+        optimized.parse();
+        optimized.optimize();
+        optimized.evaluate();
+        CHECK(optimized.value == plain.value);
+
+        // Optimizing twice keeps the values
+        optimized.optimize();
+        optimized.compile();
+        optimized.evaluate();
+        CHECK(optimized.value == plain.value);
+    }
+}
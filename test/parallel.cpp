@@ -0,0 +1,160 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests the thread pool and evaluating compiled expressions in
+/// parallel.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/context.hpp"
+#include "fluxins/error.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/parallel.hpp"
+
+TEST_CASE("Thread pool covers every item once")
+{
+    for (std::size_t threads : { 1, 2, 4, 7 })
+    {
+        for (std::size_t chunk_size : { 0, 1, 3, 1000 })
+        {
+            fluxins::thread_pool pool({ .threads = threads, .chunk_size = chunk_size });
+            CHECK(pool.size() == threads);
+
+            std::vector<std::atomic<int>> visits(1000);
+            pool.parallel_for(visits.size(), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    visits[i]++;
+                }
+            });
+
+            for (auto &visit : visits)
+            {
+                CHECK(visit == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Thread pool nested parallel for")
+{
+    fluxins::thread_pool pool({ .threads = 4, .chunk_size = 1 });
+
+    std::atomic<std::size_t> sum = 0;
+    pool.parallel_for(8, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            pool.parallel_for(10, [&](std::size_t inner_begin, std::size_t inner_end) {
+                sum += inner_end - inner_begin;
+            });
+        }
+    });
+    CHECK(sum == 80);
+}
+
+TEST_CASE("Thread pool rethrows first exception")
+{
+    fluxins::thread_pool pool({ .threads = 4, .chunk_size = 1 });
+
+    for (std::size_t run = 0; run < 10; run++)
+    {
+        try
+        {
+            pool.parallel_for(100, [&](std::size_t begin, std::size_t end) {
+                if (begin >= 20 && begin % 20 == 0)
+                {
+                    throw std::runtime_error(std::to_string(begin));
+                }
+            });
+            FAIL("Exception was not rethrown");
+        }
+        catch (const std::runtime_error &e)
+        {
+            CHECK(std::string(e.what()) == "20");
+        }
+    }
+
+    // Pool is still usable after the exception
+    std::atomic<std::size_t> count = 0;
+    pool.parallel_for(50, [&](std::size_t begin, std::size_t end) { count += end - begin; });
+    CHECK(count == 50);
+}
+
+TEST_CASE("Evaluate expressions in parallel")
+{
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+    ctx->set_variable("scale", 3.0f);
+
+    auto sum     = fluxins::compile_expression("x + y", nullptr, ctx);
+    auto product = fluxins::compile_expression("x * y * scale", nullptr, ctx);
+    auto root    = fluxins::compile_expression("sqrt(x) + pi", nullptr, ctx);
+
+    std::vector<std::vector<float>>       values;
+    std::vector<fluxins::evaluation_task> tasks;
+    for (std::size_t i = 0; i < 500; i++)
+    {
+        values.push_back({ (float) i, (float) (i % 7) });
+    }
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const fluxins::compiled_expression *compiled = i % 3 == 0 ? sum.get() : i % 3 == 1 ? product.get() : root.get();
+        tasks.push_back({ .compiled = compiled, .values = values[i], .ctx = ctx.get() });
+    }
+
+    std::vector<float> expected(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); i++)
+    {
+        expected[i] = tasks[i].compiled->evaluate(tasks[i].values, tasks[i].ctx);
+    }
+
+    // Values do not depend on how the tasks are scheduled
+    for (std::size_t threads : { 1, 3, 8 })
+    {
+        for (std::size_t chunk_size : { 0, 1, 16 })
+        {
+            fluxins::thread_pool pool({ .threads = threads, .chunk_size = chunk_size });
+
+            std::vector<float> output(tasks.size());
+            fluxins::evaluate_parallel(tasks, output, pool);
+            CHECK(output == expected);
+        }
+    }
+
+    std::vector<float> output(tasks.size());
+    fluxins::evaluate_parallel(tasks, output);
+    CHECK(output == expected);
+
+    std::vector<float> small(tasks.size() - 1);
+    CHECK_THROWS_AS(fluxins::evaluate_parallel(tasks, small), std::invalid_argument);
+}
+
+TEST_CASE("Evaluate expressions in parallel errors")
+{
+    auto compiled = fluxins::compile_expression("x + y");
+
+    std::vector<float>                    both    = { 1.0f, 2.0f };
+    std::vector<float>                    missing = { 1.0f };
+    std::vector<fluxins::evaluation_task> tasks(64, { .compiled = compiled.get(), .values = both });
+    tasks[40].values = missing;
+
+    fluxins::thread_pool pool({ .threads = 4, .chunk_size = 1 });
+    std::vector<float>   output(tasks.size());
+    CHECK_THROWS_AS(fluxins::evaluate_parallel(tasks, output, pool), fluxins::unresolved_reference);
+
+    // Tasks other than the failing one are still evaluated
+    CHECK(output[0] == 3.0f);
+    CHECK(output[63] == 3.0f);
+}
@@ -0,0 +1,262 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests vectorized math kernels and vectorized functions.
+///
+/// This project is licensed under the terms of MIT License.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fluxins/batch.hpp"
+#include "fluxins/config.hpp"
+#include "fluxins/context.hpp"
+#include "fluxins/expression.hpp"
+#include "fluxins/vector_math.hpp"
+
+/// Error of the result in units of the last place of the exact result.
+static double ulp_error(float result, double exact)
+{
+    if (std::isnan(exact)) return std::isnan(result) ? 0.0 : INFINITY;
+    if (std::isinf(exact) || std::isinf(result)) return (float) exact == result ? 0.0 : INFINITY;
+
+    float rounded = std::fabs((float) exact);
+    float ulp     = std::nextafter(rounded, INFINITY) - rounded;
+    return std::fabs(result - exact) / ulp;
+}
+
+static std::vector<float> sample_values()
+{
+    std::vector<float> values;
+    for (int i = -20000; i <= 20000; i++)
+    {
+        values.push_back((float) i * 0.005f);
+        values.push_back((float) i * 3.1f);
+        values.push_back(std::ldexp(1.0f + (float) (i & 0xFF) / 256.0f, i / 160));
+        values.push_back(-std::ldexp(1.0f + (float) (i & 0xFF) / 256.0f, i / 160));
+    }
+
+    float inf = std::numeric_limits<float>::infinity();
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    values.insert(values.end(), { 0.0f, -0.0f, inf, -inf, nan, 1e-45f, -1e-45f, 88.7f, -103.9f, 1e30f, -1e30f });
+    return values;
+}
+
+TEST_CASE("Vectorized kernels accuracy")
+{
+    using kernel_fn = void (*)(std::span<const float>, std::span<float>);
+    using exact_fn  = double (*)(double);
+
+    struct kernel_case {
+        const char *name;
+        kernel_fn   kernel;
+        exact_fn    exact;
+    };
+
+    std::vector<kernel_case> cases = {
+        { "ceil",  fluxins::simd::ceil,  [](double x) { return std::ceil(x); }  },
+        { "floor", fluxins::simd::floor, [](double x) { return std::floor(x); } },
+        { "trunc", fluxins::simd::trunc, [](double x) { return std::trunc(x); } },
+        { "sqrt",  fluxins::simd::sqrt,  [](double x) { return std::sqrt(x); }  },
+        { "exp",   fluxins::simd::exp,   [](double x) { return std::exp(x); }   },
+        { "exp2",  fluxins::simd::exp2,  [](double x) { return std::exp2(x); }  },
+        { "log",   fluxins::simd::log,   [](double x) { return std::log(x); }   },
+        { "log2",  fluxins::simd::log2,  [](double x) { return std::log2(x); }  },
+        { "log10", fluxins::simd::log10, [](double x) { return std::log10(x); } },
+        { "sin",   fluxins::simd::sin,   [](double x) { return std::sin(x); }   },
+        { "cos",   fluxins::simd::cos,   [](double x) { return std::cos(x); }   },
+        { "tan",   fluxins::simd::tan,   [](double x) { return std::tan(x); }   },
+        { "tanh",  fluxins::simd::tanh,  [](double x) { return std::tanh(x); }  },
+    };
+
+    std::vector<float> values = sample_values();
+    std::vector<float> output(values.size());
+
+    for (const auto &test : cases)
+    {
+        CAPTURE(test.name);
+        test.kernel(values, output);
+
+        double worst = 0.0;
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            double exact = test.exact(values[i]);
+            worst        = std::max(worst, ulp_error(output[i], exact));
+
+            if (!std::isnan(exact))
+            {
+                CHECK(std::signbit(output[i]) == std::signbit(exact));
+            }
+        }
+
+        MESSAGE(test.name, " max error: ", worst, " ULP");
+        CHECK(worst <= 1.0);
+    }
+}
+
+TEST_CASE("Vectorized pow accuracy")
+{
+    std::vector<float> xs = sample_values();
+    std::vector<float> ys(xs.size());
+    for (std::size_t i = 0; i < xs.size(); i++)
+    {
+        ys[i] = xs[(i * 7919) % xs.size()] * 0.01f;
+    }
+    ys.back() = 2.0f;
+
+    std::vector<float> output(xs.size());
+    fluxins::simd::pow(xs, ys, output);
+
+    double worst = 0.0;
+    for (std::size_t i = 0; i < xs.size(); i++)
+    {
+        worst = std::max(worst, ulp_error(output[i], std::pow((double) xs[i], (double) ys[i])));
+    }
+
+    MESSAGE("pow max error: ", worst, " ULP");
+    CHECK(worst <= 1.0);
+}
+
+TEST_CASE("Vectorized kernels partial blocks and aliasing")
+{
+    for (std::size_t count = 0; count <= fluxins::simd::block_size * 2 + 1; count++)
+    {
+        CAPTURE(count);
+
+        std::vector<float> values(count);
+        for (std::size_t i = 0; i < count; i++) values[i] = (float) i;
+
+        // Output is the same memory as the input
+        fluxins::simd::exp2(values, values);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            CHECK(values[i] == std::exp2((float) i));
+        }
+    }
+}
+
+TEST_CASE("Vectorized kernels timing")
+{
+    using kernel_fn = void (*)(std::span<const float>, std::span<float>);
+    using scalar_fn = float (*)(float);
+
+    struct kernel_case {
+        const char *name;
+        kernel_fn   kernel;
+        scalar_fn   scalar;
+    };
+
+    std::vector<kernel_case> cases = {
+        { "ceil",  fluxins::simd::ceil,  [](float x) { return std::ceil(x); }  },
+        { "floor", fluxins::simd::floor, [](float x) { return std::floor(x); } },
+        { "trunc", fluxins::simd::trunc, [](float x) { return std::trunc(x); } },
+        { "sqrt",  fluxins::simd::sqrt,  [](float x) { return std::sqrt(x); }  },
+        { "exp",   fluxins::simd::exp,   [](float x) { return std::exp(x); }   },
+        { "exp2",  fluxins::simd::exp2,  [](float x) { return std::exp2(x); }  },
+        { "log",   fluxins::simd::log,   [](float x) { return std::log(x); }   },
+        { "log2",  fluxins::simd::log2,  [](float x) { return std::log2(x); }  },
+        { "log10", fluxins::simd::log10, [](float x) { return std::log10(x); } },
+        { "sin",   fluxins::simd::sin,   [](float x) { return std::sin(x); }   },
+        { "cos",   fluxins::simd::cos,   [](float x) { return std::cos(x); }   },
+        { "tan",   fluxins::simd::tan,   [](float x) { return std::tan(x); }   },
+        { "tanh",  fluxins::simd::tanh,  [](float x) { return std::tanh(x); }  },
+    };
+
+    std::vector<float> values(4096);
+    for (std::size_t i = 0; i < values.size(); i++) values[i] = 0.01f + (float) i * 0.0024f;
+    std::vector<float> output(values.size());
+
+    // Only reported, timings are too noisy to check
+    constexpr int repeats = 200;
+    auto          time    = [&](auto &&run) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeats; i++) run();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / (repeats * values.size());
+    };
+
+    MESSAGE("wide vectors: ", fluxins::simd::wide_vectors());
+    for (const auto &test : cases)
+    {
+        double vectorized = time([&] { test.kernel(values, output); });
+        double scalar     = time([&] {
+            for (std::size_t i = 0; i < values.size(); i++) output[i] = test.scalar(values[i]);
+        });
+        MESSAGE(test.name, ": ", vectorized, " ns, std:: ", scalar, " ns per value");
+    }
+}
+
+TEST_CASE("Vectorized functions in context")
+{
+    auto parent = std::make_shared<fluxins::context>();
+    parent->populate();
+
+    auto child = std::make_shared<fluxins::context>();
+    child->inherit_context(parent);
+
+    CHECK(parent->resolve_vector_function("sin"));
+    CHECK(child->resolve_vector_function("sin"));
+    CHECK(child->resolve_vector_function("sin")->arity == 1);
+    CHECK_FALSE(child->resolve_vector_function("abs"));
+    CHECK_FALSE(child->resolve_vector_function("max"));
+    CHECK_FALSE(child->resolve_vector_function("unknown"));
+
+    // Shadowing function hides the parent's vectorized function
+    child->set_function("sin", [](FLUXINS_FN_PARAMS) { return params[0]; });
+    CHECK_FALSE(child->resolve_vector_function("sin"));
+
+    // Replacing function removes the vectorized function
+    parent->set_function("cos", [](FLUXINS_FN_PARAMS) { return params[0]; });
+    CHECK_FALSE(child->resolve_vector_function("cos"));
+}
+
+TEST_CASE("Batch evaluation with vectorized functions")
+{
+    auto cfg = std::make_shared<fluxins::config>();
+
+    fluxins::expression expr("twice(x) + twice(x, 1)", cfg);
+    expr.set_function("twice", [](FLUXINS_FN_PARAMS) { return params[0] * 2; });
+    expr.ctx->set_vector_function("twice", 1, [](std::span<const float *const> params, std::span<float> output) {
+        for (std::size_t i = 0; i < output.size(); i++) output[i] = params[0][i] * 2 + 1000;
+    });
+    expr.parse();
+
+    // More rows than a block
+    std::size_t        rows = fluxins::batch_block_size + 3;
+    std::vector<float> xs(rows);
+    for (std::size_t i = 0; i < rows; i++) xs[i] = (float) i;
+
+    std::vector<fluxins::column> columns = {
+        { "x", xs },
+    };
+
+    // Calls with different number of arguments use the scalar function
+    std::vector<float> output(rows);
+    expr.evaluate_batch(columns, output);
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        CHECK(output[i] == xs[i] * 4 + 1000);
+    }
+
+    auto ctx = std::make_shared<fluxins::context>();
+    ctx->populate();
+
+    fluxins::expression math("exp(-x / 100) * sin(x) + pow(x, 0.5)", cfg, ctx);
+    math.parse();
+    math.evaluate_batch(columns, output);
+    for (std::size_t i = 0; i < rows; i++)
+    {
+        float x = xs[i];
+        CHECK(output[i] == doctest::Approx(std::exp(-x / 100) * std::sin(x) + std::pow(x, 0.5f)).epsilon(1e-6));
+    }
+}